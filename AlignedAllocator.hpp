@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+/**
+ * Minimal allocator that aligns the storage to \p Alignment bytes, e.g. for SIMD loads from the start of a
+ * \p std::vector.
+ */
+template <typename T, std::size_t Alignment>
+struct AlignedAllocator {
+    static_assert(Alignment >= alignof(T));
+
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    constexpr AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    constexpr AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept { }
+
+    [[nodiscard]] T *allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t { Alignment }));
+    }
+
+    void deallocate(T *p, std::size_t) noexcept {
+        ::operator delete(p, std::align_val_t { Alignment });
+    }
+
+    template <typename U>
+    friend constexpr bool operator==(const AlignedAllocator&, const AlignedAllocator<U, Alignment>&) noexcept {
+        return true;
+    }
+};
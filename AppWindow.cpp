@@ -4,7 +4,9 @@
 
 #include "AppWindow.hpp"
 
-#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
 
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
@@ -13,40 +15,43 @@
 
 #include <OGLWrapper/Helper/Camera.hpp>
 
-#include <glm/gtc/random.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-#include <range/v3/view.hpp>
-#include <range/v3/range/conversion.hpp>
-
 void AppWindow::onFramebufferSizeCallback(OGLWrapper::GLFW::EventArg&, glm::ivec2 size) {
     aspect = getFramebufferAspectRatio();
+    scene.resize(size);
+    requestRedraw();
 }
 
 void AppWindow::onScrollCallback(OGLWrapper::GLFW::EventArg&, glm::dvec2 offset) {
     fov = std::clamp(fov.value() + static_cast<float>(offset.y), 15.f, 150.f);
+    requestRedraw();
 }
 
 void AppWindow::onCursorPosCallback(OGLWrapper::GLFW::EventArg&, glm::dvec2 position) {
     ImGuiIO &io = ImGui::GetIO();
     io.AddMousePosEvent(position.x, position.y);
+    requestRedraw();
+    marquee_end = position;
     if (io.WantCaptureMouse){
         return;
     }
 
-    // In parameter `position` is in window coordinates, but we need to convert it to framebuffer coordinates.
+    scene.setCursorPosition(toOpenGLFramebufferPosition(position));
+}
+
+glm::ivec2 AppWindow::toOpenGLFramebufferPosition(glm::dvec2 window_position) const {
+    // Window position is in window coordinates, but we need to convert it to framebuffer coordinates.
     const glm::dvec2 framebuffer_size = getFramebufferSize();
     const glm::dvec2 scale = framebuffer_size / glm::dvec2(getSize());
-    const glm::ivec2 framebuffer_cursor_position = scale * position;
+    const glm::ivec2 framebuffer_position = scale * window_position;
 
     // Since OpenGL has bottom-left origined coordinate, y-axis must be inverted.
-    const glm::ivec2 opengl_cursor_position { framebuffer_cursor_position.x, framebuffer_size.y - framebuffer_cursor_position.y };
-
-    // Read stencil value at the cursor position, store into hovered_index.
-    glReadPixels(opengl_cursor_position.x, opengl_cursor_position.y, 1, 1, GL_STENCIL_INDEX, GL_UNSIGNED_BYTE, &hovered_index);
+    return { framebuffer_position.x, framebuffer_size.y - framebuffer_position.y };
 }
 
 void AppWindow::onKeyCallback(OGLWrapper::GLFW::EventArg&, int key, int scancode, int action, int mods) {
+    requestRedraw();
     if (action == GLFW_PRESS) {
         const glm::mat4 inv_view = inverse(view.value());
         const glm::vec3 front = OGLWrapper::Helper::Camera::getFront(inv_view);
@@ -68,6 +73,40 @@ void AppWindow::onKeyCallback(OGLWrapper::GLFW::EventArg&, int key, int scancode
     }
 }
 
+void AppWindow::onMouseButtonCallback(OGLWrapper::GLFW::EventArg&, int button, int action, int mods) {
+    // Clicks are handled by ImGui, but the frame should be redrawn to reflect it.
+    requestRedraw();
+    if (button != GLFW_MOUSE_BUTTON_LEFT) {
+        return;
+    }
+
+    if (action == GLFW_PRESS && !ImGui::GetIO().WantCaptureMouse) {
+        marquee_start = marquee_end;
+    }
+    else if (action == GLFW_RELEASE && marquee_start) {
+        const glm::dvec2 drag = abs(marquee_end - *marquee_start);
+        if (std::max(drag.x, drag.y) >= marquee_threshold) {
+            scene.selectRegion(toOpenGLFramebufferPosition(*marquee_start), toOpenGLFramebufferPosition(marquee_end));
+        }
+        else {
+            scene.clearSelection();
+        }
+        marquee_start = std::nullopt;
+    }
+}
+
+void AppWindow::requestRedraw() noexcept {
+    num_pending_redraws = num_redraw_frames;
+}
+
+bool AppWindow::isRedrawRequired() const noexcept {
+    return num_pending_redraws > 0
+        || !animation_paused
+        || camera_velocity
+        || view.isDirty() || projection.isDirty()
+        || scene.isLoadingAssets(); // Finished loads are uploaded in the frame.
+}
+
 void AppWindow::update(float time_delta) {
     // If camera has velocity, i.e. user pressed WASD, `view` should be also updated.
     if (camera_velocity) {
@@ -76,31 +115,13 @@ void AppWindow::update(float time_delta) {
         view = inverse(inv_view);
     }
 
-    // Rotate models along their rotation axis.
-    for (auto &&[model, rotation_axis] : ranges::views::zip(models, rotation_axes)) {
-        model = rotate(model, time_delta, rotation_axis);
-    }
-
-    // If either `fov` or `aspect` changed, `projection` should be also updated.
-    DirtyPropertyHelper::clean([&](float fov, float aspect) {
-        projection = glm::perspective(glm::radians(fov), aspect, 1e-2f, 100.f);
-    }, fov, aspect);
-
-    // If either `view` or `projection` changed, shader's `projection_view` should be also updated.
+    // If either `view` or `projection` (i.e. `fov` or `aspect`) changed, shader's `projection_view` should be also updated.
     DirtyPropertyHelper::clean([&](const glm::mat4 &view, const glm::mat4 &projection) {
-        const glm::mat4 inv_view = inverse(view);
-        const glm::vec3 view_pos = OGLWrapper::Helper::Camera::getPosition(inv_view);
-        const glm::mat4 projection_view = projection * view;
-
-        primary_program.pendUniforms([&, projection_view, view_pos]() {
-            glUniformMatrix4fv(primary_program.getUniformLocation("vp_matrix.projection_view"), 1, GL_FALSE, value_ptr(projection_view));
-            glUniform3fv(primary_program.getUniformLocation("vp_matrix.view_pos"), 1, value_ptr(view_pos));
-        });
-        outliner_program.pendUniforms([&, projection_view, view_pos]() {
-            glUniformMatrix4fv(outliner_program.getUniformLocation("vp_matrix.projection_view"), 1, GL_FALSE, value_ptr(projection_view));
-            glUniform3fv(outliner_program.getUniformLocation("vp_matrix.view_pos"), 1, value_ptr(view_pos));
-        });
+        scene.setCamera(view, projection);
     }, view, projection);
+
+    // Paused cubes are still culled and picked, since the camera may move.
+    scene.update(animation_paused ? 0.f : time_delta);
 }
 
 void AppWindow::updateImGui(float time_delta) {
@@ -114,10 +135,13 @@ void AppWindow::updateImGui(float time_delta) {
     static float fps_average = 0.f;
     static std::size_t current_idx = 0;
 
-    fps_record[current_idx] = 1.f / time_delta;
-    if (++current_idx == fps_record.size()) {
-        current_idx = 0;
-        fps_average = std::reduce(fps_record.cbegin(), fps_record.cend()) / fps_record.size();
+    // Time delta is zero at the first frame after waiting for events.
+    if (time_delta > 0.f) {
+        fps_record[current_idx] = 1.f / time_delta;
+        if (++current_idx == fps_record.size()) {
+            current_idx = 0;
+            fps_average = std::reduce(fps_record.cbegin(), fps_record.cend()) / fps_record.size();
+        }
     }
 
     ImGui::Begin("Inspector");
@@ -128,14 +152,221 @@ void AppWindow::updateImGui(float time_delta) {
     ImGui::PlotLines("FPS", fps_record.data(), fps_record.size());
     ImGui::Text("Average FPS: %.1f", fps_average);
 
+    ImGui::Checkbox("On-demand rendering", &on_demand_rendering);
+    ImGui::SameLine();
+    ImGui::Checkbox("Pause animation", &animation_paused);
+    if (on_demand_rendering) {
+        ImGui::TextDisabled(animation_paused ? "Idle waits: %llu" : "Idle waits: %llu (animation keeps redrawing)",
+                            static_cast<unsigned long long>(num_idle_waits));
+    }
+
+    const TextureCache::Statistics texture_cache_statistics = scene.getTextureCacheStatistics();
+    ImGui::Text("Texture cache: %u hits, %u misses (%.1f ms)",
+                texture_cache_statistics.num_hits, texture_cache_statistics.num_misses, texture_cache_statistics.load_ms);
+    if (scene.isLoadingAssets()) {
+        ImGui::TextDisabled("Loading %zu assets...", scene.getNumLoadingAssets());
+    }
+
+    constexpr const char *rendering_mode_names[] = { "Per object", "Instanced" };
+    if (int mode = static_cast<int>(scene.getRenderingMode()); ImGui::Combo("Rendering mode", &mode, rendering_mode_names, IM_ARRAYSIZE(rendering_mode_names))) {
+        scene.setRenderingMode(static_cast<Scene::RenderingMode>(mode));
+    }
+    if (scene.getRenderingMode() == Scene::RenderingMode::Instanced) {
+        if (!StreamingBuffer<InstanceData>::isPersistentMappingSupported()) {
+            ImGui::TextDisabled("Instance streaming: orphaning (persistent mapping needs OpenGL 4.4)");
+        }
+        else if (bool persistent = scene.isPersistentStreaming(); ImGui::Checkbox("Persistent mapped instance buffer", &persistent)) {
+            scene.setPersistentStreaming(persistent);
+        }
+        const StreamingBuffer<InstanceData>::Statistics &statistics = scene.getInstanceStreamingStatistics();
+        ImGui::Text("Instance buffer stalls: %llu / %llu maps (%.2f ms)",
+                    static_cast<unsigned long long>(statistics.num_stalls), static_cast<unsigned long long>(statistics.num_maps), statistics.stall_ms);
+
+        ImGui::Text("Draw commands: %zu", scene.getNumDrawCommands());
+        ImGui::SameLine();
+        ImGui::TextDisabled(MultiDrawBatch::isMultiDrawIndirectSupported() ? "(multi-draw indirect)" : "(draw call loop, multi-draw indirect needs OpenGL 4.3)");
+    }
+
+    // Layout is applied at once after every widget, and only if it doesn't exceed the object limit.
+    SceneLayout scene_layout = scene.getSceneLayout();
+    bool scene_layout_changed = false;
+    constexpr const char *distribution_names[] = { "Grid", "Random", "Clustered" };
+    if (int distribution = static_cast<int>(scene_layout.distribution); ImGui::Combo("Distribution", &distribution, distribution_names, IM_ARRAYSIZE(distribution_names))) {
+        scene_layout.distribution = static_cast<SceneLayout::Distribution>(distribution);
+        scene_layout_changed = true;
+    }
+    scene_layout_changed |= ImGui::SliderInt("Roots per side", &scene_layout.num_in_side, 1, 100);
+    scene_layout_changed |= ImGui::SliderInt("Hierarchy depth", &scene_layout.hierarchy_depth, 0, 4);
+    if (scene_layout.hierarchy_depth > 0) {
+        scene_layout_changed |= ImGui::SliderInt("Children per object", &scene_layout.num_children, 1, 4);
+    }
+    if (scene_layout_changed && scene_layout.getNumObjects() <= SceneGraph::max_num_objects) {
+        scene.setSceneLayout(scene_layout);
+        if (scene.getNumInstances() >= Scene::no_hover_stencil && scene.getPickingMode() == Scene::PickingMode::Stencil) {
+            // Stencil buffer cannot distinguish that many objects.
+            scene.setPickingMode(Scene::PickingMode::ObjectId);
+        }
+    }
+    ImGui::Text("Objects: %zu (%zu meshes)", scene.getNumInstances(), scene.getNumMeshes());
+    ImGui::SameLine();
+    ImGui::TextDisabled("(at most %llu)", static_cast<unsigned long long>(SceneGraph::max_num_objects));
+    if (bool multithreaded_update = scene.isMultithreadedUpdate(); ImGui::Checkbox("Multithreaded update", &multithreaded_update)) {
+        scene.setMultithreadedUpdate(multithreaded_update);
+    }
+    ImGui::SameLine();
+    ImGui::TextDisabled("(%zu threads)", scene.getNumThreads());
+
+    if (bool frustum_culling = scene.isFrustumCulling(); ImGui::Checkbox("Frustum culling", &frustum_culling)) {
+        scene.setFrustumCulling(frustum_culling);
+    }
+    ImGui::SameLine();
+    if (bool occlusion_culling = scene.isOcclusionCulling(); ImGui::Checkbox("Occlusion culling (Hi-Z)", &occlusion_culling)) {
+        scene.setOcclusionCulling(occlusion_culling);
+    }
+    const Scene::CullingStatistics &culling_statistics = scene.getCullingStatistics();
+    ImGui::Text("Visible: %zu, frustum culled: %zu, occluded: %zu",
+                culling_statistics.num_visible, culling_statistics.num_frustum_culled, culling_statistics.num_occlusion_culled);
+
+    if (bool lod_selection = scene.isLodSelection(); ImGui::Checkbox("Level of detail", &lod_selection)) {
+        scene.setLodSelection(lod_selection);
+    }
+    if (scene.isLodSelection()) {
+        if (float threshold = scene.getLodErrorThreshold(); ImGui::SliderFloat("LOD error threshold (px)", &threshold, 0.25f, 16.f, "%.2f", ImGuiSliderFlags_Logarithmic)) {
+            scene.setLodErrorThreshold(threshold);
+        }
+    }
+    ImGui::Text("Triangles: %zu", culling_statistics.num_triangles);
+    for (std::size_t lod = 0; lod < scene.getNumLods(); ++lod) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("LOD %zu: %zu", lod, culling_statistics.num_visible_per_lod[lod]);
+    }
+
+    constexpr const char *picking_mode_names[] = { "Stencil", "Object ID buffer", "CPU ray cast (BVH)" };
+    if (ImGui::BeginCombo("Picking mode", picking_mode_names[static_cast<int>(scene.getPickingMode())])) {
+        for (int mode = 0; mode < IM_ARRAYSIZE(picking_mode_names); ++mode) {
+            // Stencil reference value cannot vary per instance, so stencil picking needs per object rendering.
+            const bool disabled = static_cast<Scene::PickingMode>(mode) == Scene::PickingMode::Stencil
+                && scene.getRenderingMode() == Scene::RenderingMode::Instanced;
+            const bool selected = static_cast<Scene::PickingMode>(mode) == scene.getPickingMode();
+            if (ImGui::Selectable(picking_mode_names[mode], selected, disabled ? ImGuiSelectableFlags_Disabled : ImGuiSelectableFlags_None)) {
+                scene.setPickingMode(static_cast<Scene::PickingMode>(mode));
+            }
+        }
+        ImGui::EndCombo();
+    }
+    if (scene.getRenderingMode() == Scene::RenderingMode::Instanced) {
+        ImGui::TextDisabled("Stencil picking needs per object rendering.");
+    }
+    else if (scene.getPickingMode() == Scene::PickingMode::Stencil && scene.getNumInstances() >= Scene::no_hover_stencil) {
+        ImGui::TextDisabled("Stencil picking cannot pick objects from index %d on.", Scene::no_hover_stencil);
+    }
+    if (scene.getPickingMode() != Scene::PickingMode::CpuRayCast) {
+        if (bool async_readback = scene.isAsyncReadback(); ImGui::Checkbox("Asynchronous readback (PBO)", &async_readback)) {
+            scene.setAsyncReadback(async_readback);
+        }
+        if (scene.isAsyncReadback()) {
+            const PixelReadback::Statistics &statistics = scene.getReadbackStatistics();
+            ImGui::Text("Picking latency: %.2f ms (%llu frames)", statistics.latency_ms, static_cast<unsigned long long>(statistics.latency_frames));
+            ImGui::Text("Readback stalls: %llu", static_cast<unsigned long long>(statistics.num_stalls));
+        }
+    }
+    // Pickings skipped since neither the cursor pixel, the camera nor the objects changed.
+    const PickingCache::Statistics &picking_cache_statistics = scene.getPickingCacheStatistics();
+    ImGui::Text("Picking cache: %llu hits, %llu misses", static_cast<unsigned long long>(picking_cache_statistics.num_hits), static_cast<unsigned long long>(picking_cache_statistics.num_misses));
+
+    // Uniform locations are resolved at startup, so this should stay zero. Otherwise, something looks them up every frame.
+    static std::uint64_t num_uniform_lookups = UniformLocation::getNumLookups();
+    ImGui::Text("Uniform lookups in last frame: %llu", static_cast<unsigned long long>(UniformLocation::getNumLookups() - num_uniform_lookups));
+    num_uniform_lookups = UniformLocation::getNumLookups();
+
+    if (ImGui::CollapsingHeader("Profiler")) {
+        if (ImGui::BeginTable("Zones", 3)) {
+            ImGui::TableSetupColumn("Zone");
+            ImGui::TableSetupColumn("CPU (ms)");
+            ImGui::TableSetupColumn("GPU (ms)");
+            ImGui::TableHeadersRow();
+            for (const Profiler::Zone &zone : profiler.getZones()) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%*s%s", static_cast<int>(2 * zone.depth), "", zone.name);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", zone.cpu_ms_average);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", zone.gpu_ms_average);
+            }
+            ImGui::EndTable();
+        }
+
+        for (const Profiler::Zone &zone : profiler.getZones()) {
+            ImGui::PushID(zone.name);
+            ImGui::PlotHistogram("##cpu", zone.cpu_ms.data(), zone.cpu_ms.size(), profiler.getHistoryOffset(), zone.name, 0.f, 4.f * zone.cpu_ms_average);
+            ImGui::SameLine();
+            ImGui::PlotHistogram("##gpu", zone.gpu_ms.data(), zone.gpu_ms.size(), profiler.getGpuHistoryOffset(), "GPU", 0.f, 4.f * zone.gpu_ms_average);
+            ImGui::PopID();
+        }
+
+        static std::string trace_message;
+        if (ImGui::Button("Dump Chrome trace")) {
+            constexpr const char *trace_path = "profile_trace.json";
+            try {
+                profiler.writeChromeTrace(trace_path);
+                trace_message = std::string { "Written to " } + trace_path;
+            }
+            catch (const std::runtime_error &e) {
+                trace_message = e.what();
+            }
+        }
+        ImGui::SameLine();
+        ImGui::TextDisabled("%s", trace_message.c_str());
+    }
+
     if (static glm::vec3 outline_color { 1.f, 0.5f, 0.2f }; ImGui::ColorEdit3("Outline color", value_ptr(outline_color))) {
-        outliner_program.pendUniforms([& /* outline_color is in static lifetime: no need to value capture */]() {
-            glUniform3fv(outliner_program.getUniformLocation("color"), 1, value_ptr(outline_color));
-        });
+        scene.setOutlineColor(outline_color);
+    }
+
+    static std::string recording_message;
+    if (!input_recorder) {
+        if (ImGui::Button("Record input")) {
+            try {
+                startRecording();
+                recording_message.clear();
+            }
+            catch (const std::runtime_error &e) {
+                recording_message = e.what();
+            }
+        }
+    }
+    else if (ImGui::Button("Stop recording")) {
+        recording_message = "Written " + std::to_string(input_recorder->getNumFrames()) + " frames to " + recording_path;
+        stopRecording();
+    }
+    ImGui::SameLine();
+    if (input_recorder) {
+        ImGui::TextDisabled("Recording frame %llu at %.0f FPS fixed step", static_cast<unsigned long long>(input_recorder->getNumFrames()), 1.f / recording_time_step);
+    }
+    else {
+        ImGui::TextDisabled("%s", recording_message.c_str());
+    }
+
+    ImGui::Text("Selected cubes: %zu (drag to select)", scene.getSelectedIndices().size());
+    if (!scene.getSelectedIndices().empty()) {
+        ImGui::SameLine();
+        if (ImGui::Button("Clear selection")) {
+            scene.clearSelection();
+        }
     }
 
     ImGui::End();
 
+    // Marquee rectangle while dragging.
+    if (marquee_start) {
+        const ImVec2 min { static_cast<float>(std::min(marquee_start->x, marquee_end.x)), static_cast<float>(std::min(marquee_start->y, marquee_end.y)) };
+        const ImVec2 max { static_cast<float>(std::max(marquee_start->x, marquee_end.x)), static_cast<float>(std::max(marquee_start->y, marquee_end.y)) };
+        ImDrawList *draw_list = ImGui::GetForegroundDrawList();
+        draw_list->AddRectFilled(min, max, IM_COL32(50, 150, 255, 40));
+        draw_list->AddRect(min, max, IM_COL32(50, 150, 255, 200));
+    }
+
     ImGuizmo::BeginFrame();
 
     // Clone the view matrix and pass it to ImGuizmo.
@@ -155,53 +386,64 @@ void AppWindow::updateImGui(float time_delta) {
     ImGui::Render();
 }
 
-void AppWindow::draw() const {
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-
-    primary_program.use();
-    for (auto &&[idx, model] : models | ranges::views::enumerate) {
-        glUniformMatrix4fv(primary_program.getUniformLocation("model"), 1, GL_FALSE, value_ptr(model));
-
-        const glm::mat4 inv_model = inverse(model);
-        glUniformMatrix4fv(primary_program.getUniformLocation("inv_model"), 1, GL_FALSE, value_ptr(inv_model));
+void AppWindow::drawImGui() const {
+    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+}
 
-        glStencilFunc(GL_ALWAYS, static_cast<GLint>(idx), 0xFF);
-        cube_mesh.draw();
+void AppWindow::onRenderLoop(float time_delta) {
+    if (on_demand_rendering && !isRedrawRequired()) {
+        // Last frame is still valid. Instead of drawing the same frame again, block until any event arrives. Each
+        // iteration of the loop still draws a complete frame, because the window swaps the buffers after this.
+        glfwWaitEvents();
+        ++num_idle_waits;
+        requestRedraw();
+
+        // Waiting time should not be animated.
+        time_delta = 0.f;
+    }
+    else if (input_recorder) {
+        time_delta = recording_time_step;
     }
 
-    if (hovered_index != no_hover_index) {
-        // If there is a mesh under the cursor (retrieved by stencil test), draw it with slightly scaled model.
-        outliner_program.use();
-
-        // The stencil function set to GL_NOTEQUAL with reference value = hovered_index will pass only scaled fragments
-        // (i.e. outline) of the mesh.
-        glStencilFunc(GL_NOTEQUAL, static_cast<GLint>(hovered_index), no_hover_index);
-        glStencilMask(0x00);
-        glDisable(GL_DEPTH_TEST);
-
-        constexpr float scale_factor = 1.05f;
-
-        assert(hovered_index < models.size());
-        const glm::mat4 scaled_model = scale(models[hovered_index], glm::vec3 { scale_factor });
-        glUniformMatrix4fv(outliner_program.getUniformLocation("model"), 1, GL_FALSE, value_ptr(scaled_model));
-
-        cube_mesh.draw();
+    profiler.beginFrame();
+    {
+        const Profiler::Scope zone { &profiler, "update" };
+        update(time_delta);
+    }
+    {
+        const Profiler::Scope zone { &profiler, "updateImGui" };
+        updateImGui(time_delta);
+    }
+    {
+        const Profiler::Scope zone { &profiler, "draw" };
+        scene.draw();
+    }
+    // Stencil/object ID buffer is complete after the scene is drawn (ImGui doesn't write to them).
+    scene.endFrame();
+    {
+        const Profiler::Scope zone { &profiler, "drawImGui" };
+        drawImGui();
+    }
 
-        // Settings should be restored for next render loop.
-        glStencilMask(0xFF);
-        glEnable(GL_DEPTH_TEST);
+    // Hovered index may be changed without any event, e.g. by asynchronous readback or ray cast with moving cubes.
+    if (scene.getHoveredIndex() != last_hovered_index) {
+        last_hovered_index = scene.getHoveredIndex();
+        requestRedraw();
+    }
+    else if (num_pending_redraws > 0) {
+        --num_pending_redraws;
     }
 }
 
-void AppWindow::drawImGui() const {
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+void AppWindow::startRecording() {
+    // Scene is reset with the seed of the recording, and then every frame is recorded until stopRecording().
+    input_recorder = std::make_unique<InputRecorder>(recording_path, scene.getRandomSeed(), recording_time_step);
+    scene.setRecorder(input_recorder.get());
 }
 
-void AppWindow::onRenderLoop(float time_delta) {
-    update(time_delta);
-    updateImGui(time_delta);
-    draw();
-    drawImGui();
+void AppWindow::stopRecording() {
+    scene.setRecorder(nullptr);
+    input_recorder.reset();
 }
 
 void AppWindow::initImGui() {
@@ -219,74 +461,24 @@ void AppWindow::initImGui() {
     ImGui_ImplOpenGL3_Init("#version 330");
 }
 
-void AppWindow::initModels() {
-    constexpr auto linspace = ranges::views::linear_distribute(-2.f, 2.f, num_cube_in_side);
-
-    static constexpr glm::mat4 identity = glm::identity<glm::mat4>();
-    models =
-        ranges::views::cartesian_product(linspace, linspace, linspace)
-        | ranges::views::transform([](auto &&xyz) -> glm::mat4 {
-            const glm::vec3 offset = std::make_from_tuple<glm::vec3>(xyz);
-            return translate(identity, offset);
-        })
-        | ranges::to_vector;
-
-    rotation_axes =
-        ranges::views::generate_n([]() -> glm::vec3 { return glm::sphericalRand(1.f); }, models.size())
-        | ranges::to_vector;
-}
-
-OGLWrapper::Helper::GpuMesh<VertexPNT> AppWindow::loadCubeMesh() {
-    // TODO: use proper format (e.g. .obj)
-    std::ifstream cube_file { "assets/models/cube.txt" };
-    assert(cube_file.is_open());
-
-    std::vector<VertexPNT> vertices;
-    for (VertexPNT vertex; cube_file >> vertex;) {
-        vertices.push_back(vertex);
-    }
-
-    return OGLWrapper::Helper::Mesh { std::move(vertices) }
-        .transferToGpu({ 0, 1, 2 }, GL_STATIC_DRAW);
-}
-
 AppWindow::AppWindow() : Window { 640, 640, "Mouse picking", {} },
-                         cube_mesh { loadCubeMesh() },
                          view { lookAt(
                              camera_distance * normalize(glm::vec3 { 1.f }),
                              glm::vec3 { 0.f },
                              glm::vec3 { 0.f, 1.f, 0.f }) }
 {
+    scene.setProfiler(&profiler);
     initImGui();
-    initModels();
 
     framebuffer_size_callback.append(std::bind_front(&AppWindow::onFramebufferSizeCallback, this));
     scroll_callback.append(std::bind_front(&AppWindow::onScrollCallback, this));
     cursor_pos_callback.append(std::bind_front(&AppWindow::onCursorPosCallback, this));
     key_callback.append(std::bind_front(&AppWindow::onKeyCallback, this));
-
-    // Set texture.
-    primary_program.pendUniforms([&]() {
-        glUniform1i(primary_program.getUniformLocation("diffuse_map"), 0);
-        glUniform1i(primary_program.getUniformLocation("specular_map"), 1);
-    });
-    wood.setTexture(GL_TEXTURE0, GL_TEXTURE1);
-
-    // Enable OpenGL features.
-    glEnable(GL_DEPTH_TEST);
-
-    glEnable(GL_CULL_FACE);
-
-    // At first, stencil buffer will filled with `no_hover_index`.
-    // At draw call, stencil buffer will be filled with `idx` if the fragment is drawn and depth test is passed.
-    // After that, we can retrieve the index of the mesh under the cursor by reading stencil buffer.
-    glEnable(GL_STENCIL_TEST);
-    glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
-    glStencilMask(0xFF);
-    glClearStencil(no_hover_index);
+    mouse_button_callback.append(std::bind_front(&AppWindow::onMouseButtonCallback, this));
 }
 
 AppWindow::~AppWindow() {
+    stopRecording();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
@@ -4,51 +4,30 @@
 
 #pragma once
 
-#include <vector>
+#include <memory>
+#include <optional>
 
-#include <OGLWrapper/Shader.hpp>
-#include <OGLWrapper/Program.hpp>
 #include <OGLWrapper/OpenGLContext.hpp>
-#include <OGLWrapper/Helper/Image.hpp>
-#include <OGLWrapper/Helper/Mesh.hpp>
 #include <OGLWrapper/GLFW/Window.hpp>
 
+#include <glm/ext/matrix_clip_space.hpp>
 #include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_int2.hpp>
 
 #include <DirtyProperty.hpp>
+#include <DirtyPropertyGraph.hpp>
 
-#include "Vertex.hpp"
-#include "Material.hpp"
+#include "InputLog.hpp"
+#include "Profiler.hpp"
+#include "Scene.hpp"
 
 class AppWindow final : public OGLWrapper::GLFW::Window {
     // This struct should be at the top of the class declaration, because it is intended to be initialized before
     // the constructor.
     OGLWrapper::OpenGLContext context {};
 
-    const OGLWrapper::Program primary_program {
-        OGLWrapper::VertexShader { "shaders/cube.vert" },
-        OGLWrapper::FragmentShader { "shaders/cube.frag" }
-    };
-    const OGLWrapper::Program outliner_program {
-        OGLWrapper::VertexShader { "shaders/outliner.vert" },
-        OGLWrapper::FragmentShader { "shaders/outliner.frag" }
-    };
-
-    const Material wood {
-        OGLWrapper::Helper::Image { "assets/textures/container2.png" }.toTexture<GL_TEXTURE_2D>(),
-        OGLWrapper::Helper::Image { "assets/textures/container2_specular.png" }.toTexture<GL_TEXTURE_2D>(),
-    };
-
-    OGLWrapper::Helper::GpuMesh<VertexPNT> cube_mesh;
-
-    static constexpr std::size_t num_cube_in_side = 6;
-    static constexpr std::size_t num_cubes = num_cube_in_side * num_cube_in_side * num_cube_in_side;
-    static constexpr std::uint8_t no_hover_index = 0xFF;
-    static_assert(num_cubes < no_hover_index);
-    std::uint8_t hovered_index = no_hover_index;
-
-    std::vector<glm::vec3> rotation_axes;
-    std::vector<glm::mat4> models;
+    Scene scene { getFramebufferSize() };
+    Profiler profiler;
 
     // View/projection related properties.
     static constexpr float camera_distance = 10.f;
@@ -57,25 +36,56 @@ class AppWindow final : public OGLWrapper::GLFW::Window {
 
     DirtyProperty<float> aspect { 1.f };
     DirtyProperty<float> fov { 45.f };
-    DirtyProperty<glm::mat4> projection;
+    // Recomputed lazily when either `fov` or `aspect` changed.
+    DerivedProperty<glm::mat4, DirtyProperty<float>, DirtyProperty<float>> projection {
+        [](float fov, float aspect) { return glm::perspective(glm::radians(fov), aspect, 1e-2f, 100.f); },
+        fov, aspect
+    };
+
+    // On-demand rendering related properties. If enabled, the render loop blocks until an event arrives, unless
+    // something has to be redrawn.
+    bool on_demand_rendering = false;
+    bool animation_paused = false;
+    // Frames to be rendered after an event. ImGui needs a few frames to settle its hover/active states, and the
+    // asynchronous readback result arrives PixelReadback::latency frames after the cursor is moved.
+    static constexpr int num_redraw_frames = PixelReadback::latency + 2;
+    int num_pending_redraws = num_redraw_frames;
+    std::uint32_t last_hovered_index = Scene::no_hover_index;
+    std::uint64_t num_idle_waits = 0;
+
+    // Marquee selection related properties, in window coordinates.
+    static constexpr double marquee_threshold = 4.0; // Smaller drags are treated as clicks, which clear the selection.
+    std::optional<glm::dvec2> marquee_start;
+    glm::dvec2 marquee_end { 0.0 };
+
+    // Input recording related properties. While recording, the application advances by a fixed time step regardless
+    // of the frame time, so that the replay reproduces the same frames.
+    static constexpr float recording_time_step = 1.f / 60.f;
+    static constexpr const char *recording_path = "input_recording.log";
+    std::unique_ptr<InputRecorder> input_recorder;
+
+    void startRecording();
+    void stopRecording();
+
+    [[nodiscard]] glm::ivec2 toOpenGLFramebufferPosition(glm::dvec2 window_position) const;
 
     // Window event handlers.
     void onFramebufferSizeCallback(OGLWrapper::GLFW::EventArg&, glm::ivec2 size);
     void onScrollCallback(OGLWrapper::GLFW::EventArg&, glm::dvec2 offset);
     void onCursorPosCallback(OGLWrapper::GLFW::EventArg&, glm::dvec2 position);
     void onKeyCallback(OGLWrapper::GLFW::EventArg&, int key, int scancode, int action, int mods);
+    void onMouseButtonCallback(OGLWrapper::GLFW::EventArg&, int button, int action, int mods);
+
+    void requestRedraw() noexcept;
+    [[nodiscard]] bool isRedrawRequired() const noexcept;
 
     // Render loop related functions.
     void update(float time_delta);
     void updateImGui(float time_delta);
-    void draw() const;
     void drawImGui() const;
     void onRenderLoop(float time_delta) override;
 
     void initImGui();
-    void initModels();
-
-    static OGLWrapper::Helper::GpuMesh<VertexPNT> loadCubeMesh();
 
 public:
     AppWindow();
@@ -0,0 +1,75 @@
+#include "AssetLoader.hpp"
+
+#include <chrono>
+#include <limits>
+#include <utility>
+
+// JobSystem counts the calling thread of parallelFor(), which never calls it here.
+AssetLoader::AssetLoader(std::size_t num_threads) : job_system { std::make_unique<JobSystem>(num_threads + 1) } {
+
+}
+
+AssetLoader::~AssetLoader() {
+    // Unstarted loads are dropped, and the running ones finish before the join.
+    job_system.reset();
+
+    for (Node *node = finished_head.exchange(nullptr, std::memory_order_acquire); node;) {
+        delete std::exchange(node, node->next);
+    }
+}
+
+std::size_t AssetLoader::processUploads(float budget_ms) {
+    collectFinished();
+    if (ready_uploads.empty()) {
+        return 0;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto elapsed_ms = [&]() {
+        return std::chrono::duration<float, std::milli> { std::chrono::steady_clock::now() - start }.count();
+    };
+
+    std::size_t num_uploaded = 0;
+    do {
+        // Popped before the invocation, so that a throwing upload is not executed again.
+        const std::function upload = std::move(ready_uploads.front());
+        ready_uploads.pop_front();
+        --num_pending;
+        ++num_uploaded;
+        upload();
+    } while (!ready_uploads.empty() && elapsed_ms() < budget_ms);
+
+    statistics.num_uploaded += num_uploaded;
+    statistics.upload_ms += elapsed_ms();
+    if (!ready_uploads.empty()) {
+        ++statistics.num_deferred_frames;
+    }
+    return num_uploaded;
+}
+
+void AssetLoader::finish() {
+    while (num_pending != 0) {
+        if (processUploads(std::numeric_limits<float>::infinity()) == 0) {
+            std::this_thread::yield(); // Loads are still running.
+        }
+    }
+}
+
+void AssetLoader::push(std::function<void()> upload) {
+    Node *const node = new Node { std::move(upload), finished_head.load(std::memory_order_relaxed) };
+    while (!finished_head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void AssetLoader::collectFinished() {
+    // Stack is in the reverse order of completion.
+    Node *node = finished_head.exchange(nullptr, std::memory_order_acquire);
+    Node *reversed = nullptr;
+    while (node) {
+        reversed = std::exchange(node, std::exchange(node->next, reversed));
+    }
+
+    while (reversed) {
+        ready_uploads.push_back(std::move(reversed->upload));
+        delete std::exchange(reversed, reversed->next);
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+#include "JobSystem.hpp"
+
+/**
+ * Asynchronous asset loading in two stages: CPU work (reading, decoding, conversion) on the loader threads, and GPU
+ * upload on the render thread that calls \p processUploads() once per frame under a time budget.
+ *
+ * Finished CPU results are handed over through a lock-free multi-producer single-consumer queue, so loader threads never
+ * block the render thread. Loader threads are separated from the scene's \p JobSystem, so that a long decoding job is
+ * never picked up by the render thread while it waits for its own parallel work.
+ *
+ * @code
+ * asset_loader.load(
+ *     [path]() { return decodeImage(path); },                  // Loader thread.
+ *     [&](const Image &image) { uploadTexture(image); });     // Render thread, in processUploads().
+ *
+ * // Every frame.
+ * asset_loader.processUploads(2.f);
+ * @endcode
+ *
+ * @note \p load() and \p processUploads() must be called from the same (render) thread.
+ */
+class AssetLoader {
+public:
+    struct Statistics {
+        std::size_t num_uploaded = 0;
+        std::size_t num_deferred_frames = 0; // How many times uploads were left for the next frame by the budget.
+        float upload_ms = 0.f;               // Total time spent by the uploads.
+    };
+
+    /**
+     * @param num_threads Number of loader threads. Defaults to the half of the hardware concurrency, leaving the rest for
+     * the scene's job system.
+     */
+    explicit AssetLoader(std::size_t num_threads = std::max(std::thread::hardware_concurrency() / 2, 1U));
+    ~AssetLoader();
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader &operator=(const AssetLoader&) = delete;
+
+    /**
+     * @brief Execute \p load on a loader thread, and then \p upload with its result on the render thread.
+     * @param load Invoked without argument. Exception thrown by it is rethrown by \p processUploads().
+     * @param upload Invoked with the result of \p load as an lvalue.
+     */
+    template <typename Load, typename Upload> requires std::invocable<Upload, std::invoke_result_t<Load>&>
+    void load(Load &&load, Upload &&upload) {
+        ++num_pending;
+        job_system->submit([this, load = std::forward<Load>(load), upload = std::forward<Upload>(upload)]() {
+            try {
+                // Result is shared, since std::function requires a copyable closure.
+                auto result = std::make_shared<std::invoke_result_t<Load>>(std::invoke(load));
+                push([upload, result]() {
+                    std::invoke(upload, *result);
+                });
+            }
+            catch (...) {
+                push([exception = std::current_exception()]() {
+                    std::rethrow_exception(exception);
+                });
+            }
+        });
+    }
+
+    /**
+     * @brief Execute the uploads of the finished loads, until the time budget is exhausted. At least one upload is
+     * executed if any is ready, so that the loads always progress.
+     * @param budget_ms Time budget in milliseconds.
+     * @return Number of the executed uploads.
+     * @throw Exception thrown by a load function, or by an upload function.
+     */
+    std::size_t processUploads(float budget_ms);
+
+    /**
+     * @brief Execute every upload, waiting for the loads to finish.
+     */
+    void finish();
+
+    /**
+     * @brief Get the number of loads whose upload is not executed yet.
+     */
+    [[nodiscard]] std::size_t getNumPending() const noexcept {
+        return num_pending;
+    }
+
+    [[nodiscard]] const Statistics &getStatistics() const noexcept {
+        return statistics;
+    }
+
+private:
+    struct Node {
+        std::function<void()> upload;
+        Node *next;
+    };
+
+    // Stack of finished loads pushed by the loader threads. Render thread takes the whole stack at once.
+    std::atomic<Node*> finished_head = nullptr;
+    std::deque<std::function<void()>> ready_uploads; // In the order of completion. Render thread only.
+    std::size_t num_pending = 0;
+    Statistics statistics;
+
+    // Destroyed (joined) explicitly in the destructor before freeing the stack, since the running jobs push to it.
+    std::unique_ptr<JobSystem> job_system;
+
+    void push(std::function<void()> upload);
+    void collectFinished();
+};
@@ -0,0 +1,74 @@
+#include "Bvh.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+Bvh::Bvh(std::span<const AABB> primitive_bounds) : primitive_indices(primitive_bounds.size()) {
+    if (primitive_bounds.empty()) {
+        return;
+    }
+
+    std::iota(primitive_indices.begin(), primitive_indices.end(), 0U);
+
+    // A binary tree with n leaves has 2n - 1 nodes at most.
+    nodes.reserve(2 * primitive_bounds.size() - 1);
+    buildRecursive(primitive_bounds, 0, static_cast<std::uint32_t>(primitive_bounds.size()));
+}
+
+void Bvh::refit(std::span<const AABB> primitive_bounds) {
+    assert(primitive_bounds.size() == primitive_indices.size());
+
+    // Children are always located after their parent, therefore reverse iteration visits children first.
+    for (std::size_t node_index = nodes.size(); node_index-- > 0;) {
+        Node &node = nodes[node_index];
+        node.bounds = {};
+        if (node.isLeaf()) {
+            for (std::uint32_t primitive_index : std::span { primitive_indices }.subspan(node.offset, node.count)) {
+                node.bounds.expand(primitive_bounds[primitive_index]);
+            }
+        }
+        else {
+            node.bounds.expand(nodes[node_index + 1].bounds);
+            node.bounds.expand(nodes[node.offset].bounds);
+        }
+    }
+}
+
+std::uint32_t Bvh::buildRecursive(std::span<const AABB> primitive_bounds, std::uint32_t begin, std::uint32_t end) {
+    const auto node_index = static_cast<std::uint32_t>(nodes.size());
+    nodes.emplace_back();
+
+    AABB bounds, centroid_bounds;
+    for (std::uint32_t primitive_index : std::span { primitive_indices }.subspan(begin, end - begin)) {
+        bounds.expand(primitive_bounds[primitive_index]);
+        centroid_bounds.expand(primitive_bounds[primitive_index].center());
+    }
+
+    // Split along the axis with the largest centroid extent.
+    const glm::vec3 centroid_extent = centroid_bounds.extent();
+    const int axis = centroid_extent.x > centroid_extent.y
+        ? (centroid_extent.x > centroid_extent.z ? 0 : 2)
+        : (centroid_extent.y > centroid_extent.z ? 1 : 2);
+
+    // If there are few primitives or all centroids are at the same position, splitting is meaningless.
+    if (end - begin <= max_leaf_size || centroid_extent[axis] <= 0.f) {
+        nodes[node_index] = { bounds, begin, end - begin };
+        return node_index;
+    }
+
+    // Median split: the resulting tree is balanced, so its depth never exceeds the traversal stack size.
+    const std::uint32_t mid = begin + (end - begin) / 2;
+    std::nth_element(
+        primitive_indices.begin() + begin,
+        primitive_indices.begin() + mid,
+        primitive_indices.begin() + end,
+        [&](std::uint32_t lhs, std::uint32_t rhs) {
+            return primitive_bounds[lhs].center()[axis] < primitive_bounds[rhs].center()[axis];
+        });
+
+    buildRecursive(primitive_bounds, begin, mid);
+    const std::uint32_t right_child = buildRecursive(primitive_bounds, mid, end);
+    nodes[node_index] = { bounds, right_child, 0 };
+    return node_index;
+}
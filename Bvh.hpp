@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "Geometry.hpp"
+
+/**
+ * Bounding volume hierarchy over a set of primitive AABBs (in this application, the world space bounds of each model
+ * instance).
+ *
+ * Nodes are stored in depth-first pre-order, so the left child of an internal node is always the next node and every
+ * child has larger index than its parent. It makes \p refit() a single reverse linear pass, therefore the hierarchy can
+ * be built once and refitted every frame as the instances move, instead of being rebuilt.
+ *
+ * @code
+ * Bvh bvh { instance_bounds };
+ * // ...instances moved, instance_bounds updated.
+ * bvh.refit(instance_bounds);
+ * const auto hit = bvh.closestHit(ray, [&](std::uint32_t primitive_index, float t_max) -> std::optional<float> {
+ *     // Narrow-phase test for the primitive.
+ * });
+ * @endcode
+ */
+class Bvh {
+public:
+    struct Node {
+        AABB bounds;
+        // If leaf (count != 0), offset of the first primitive in primitive_indices. Otherwise, index of the right child.
+        std::uint32_t offset;
+        std::uint32_t count;
+
+        [[nodiscard]] bool isLeaf() const noexcept {
+            return count != 0;
+        }
+    };
+
+    struct Hit {
+        std::uint32_t primitive_index;
+        float distance;
+    };
+
+    static constexpr std::uint32_t max_leaf_size = 4;
+
+    Bvh() = default;
+    explicit Bvh(std::span<const AABB> primitive_bounds);
+
+    /**
+     * @brief Update node bounds with the new primitive bounds, while keeping the tree topology.
+     * @param primitive_bounds New primitive bounds. Its size must be same as the one used for construction.
+     * @note The tree quality gets worse if primitives are moved far from their initial positions. In that case,
+     * construct a new one.
+     */
+    void refit(std::span<const AABB> primitive_bounds);
+
+    /**
+     * @brief Find the closest primitive intersected by \p ray.
+     * @param ray Ray to test. Its direction doesn't have to be normalized.
+     * @param intersect_primitive Narrow-phase test, invoked as <tt>intersect_primitive(primitive_index, t_max)</tt> for
+     * every primitive whose bounds are hit by the ray. It must return the ray parameter of the closest intersection which
+     * is less than \p t_max, or \p std::nullopt if there is no such intersection.
+     * @return Index and ray parameter of the closest primitive, or \p std::nullopt if ray hits nothing.
+     */
+    template <typename F>
+        requires std::is_invocable_r_v<std::optional<float>, F, std::uint32_t, float>
+    [[nodiscard]] std::optional<Hit> closestHit(const Ray &ray, F &&intersect_primitive) const {
+        if (nodes.empty()) {
+            return std::nullopt;
+        }
+
+        const glm::vec3 inv_direction = 1.f / ray.direction;
+        std::optional<Hit> closest;
+        float t_max = std::numeric_limits<float>::max();
+
+        // Tree depth is bounded by log2(primitive count) because of the median split.
+        std::array<std::uint32_t, 64> stack;
+        std::size_t stack_size = 0;
+        stack[stack_size++] = 0;
+
+        while (stack_size != 0) {
+            const Node &node = nodes[stack[--stack_size]];
+            if (!ray.intersect(inv_direction, node.bounds, t_max)) {
+                continue;
+            }
+
+            if (node.isLeaf()) {
+                for (std::uint32_t primitive_index : std::span { primitive_indices }.subspan(node.offset, node.count)) {
+                    if (auto t = intersect_primitive(primitive_index, t_max); t && *t < t_max) {
+                        t_max = *t;
+                        closest = Hit { primitive_index, *t };
+                    }
+                }
+            }
+            else {
+                const std::uint32_t node_index = static_cast<std::uint32_t>(&node - nodes.data());
+                stack[stack_size++] = node.offset;
+                stack[stack_size++] = node_index + 1;
+            }
+        }
+
+        return closest;
+    }
+
+    [[nodiscard]] std::span<const Node> getNodes() const noexcept {
+        return nodes;
+    }
+
+private:
+    std::vector<Node> nodes;
+    std::vector<std::uint32_t> primitive_indices;
+
+    std::uint32_t buildRecursive(std::span<const AABB> primitive_bounds, std::uint32_t begin, std::uint32_t end);
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Range of the shared index buffer drawn for a mesh at a level of detail. Indices are relative to \p base_vertex.
+ */
+struct DrawRange {
+    std::uint32_t first_index;
+    std::uint32_t index_count;
+    std::int32_t base_vertex;
+    float error; // Distance from the LOD 0 surface, for the LOD selection. Not a part of the draw command.
+};
+
+/**
+ * Layout of a command consumed by \p glMultiDrawElementsIndirect (and \p glDrawElementsIndirect).
+ */
+struct DrawElementsIndirectCommand {
+    std::uint32_t count;
+    std::uint32_t instance_count;
+    std::uint32_t first_index;
+    std::int32_t base_vertex;
+    std::uint32_t base_instance;
+
+    bool operator==(const DrawElementsIndirectCommand&) const = default;
+};
+static_assert(sizeof(DrawElementsIndirectCommand) == 5 * sizeof(std::uint32_t));
+
+/**
+ * Builds the draw commands of a set of objects, each drawn with one of the draw ranges. Objects are grouped by their
+ * ranges with counting sort, and each non-empty group becomes a command whose instances are consecutive from its base
+ * instance. It doesn't touch OpenGL, so the commands can be built (and inspected) without a context.
+ *
+ * Instance attributes must be written in \p getInstanceOrder(), so that the attributes of the i-th instance are the ones of
+ * the object <tt>getInstanceOrder()[i]</tt>. Since the object ID is one of the attributes, the picked IDs are the same as
+ * drawing each object one by one.
+ *
+ * @code
+ * builder.build(visible_indices, pool.getDrawRanges(), [&](std::uint32_t idx) { return draw_range_of[idx]; });
+ * std::span<InstanceData> mapped = batch.mapInstances(builder.getInstanceOrder().size());
+ * for (std::size_t i = 0; i < mapped.size(); ++i) {
+ *     mapped[i] = instances[builder.getInstanceOrder()[i]];
+ * }
+ * batch.unmapInstances();
+ * batch.draw(builder.getCommands());
+ * @endcode
+ */
+class DrawCommandBuilder {
+public:
+    /**
+     * @brief Build the commands, replacing the previous ones.
+     * @param object_indices Objects to draw. Objects in the same range keep their order.
+     * @param ranges Draw ranges.
+     * @param range_of Function that returns the index of the draw range of an object index.
+     */
+    template <typename F> requires std::is_invocable_r_v<std::uint32_t, F, std::uint32_t>
+    void build(std::span<const std::uint32_t> object_indices, std::span<const DrawRange> ranges, F &&range_of) {
+        range_offsets.assign(ranges.size() + 1, 0);
+        for (std::uint32_t index : object_indices) {
+            ++range_offsets[range_of(index) + 1];
+        }
+        std::partial_sum(range_offsets.begin(), range_offsets.end(), range_offsets.begin());
+
+        commands.clear();
+        for (std::size_t range = 0; range < ranges.size(); ++range) {
+            if (const std::uint32_t instance_count = range_offsets[range + 1] - range_offsets[range]; instance_count != 0) {
+                commands.push_back({
+                    .count = ranges[range].index_count,
+                    .instance_count = instance_count,
+                    .first_index = ranges[range].first_index,
+                    .base_vertex = ranges[range].base_vertex,
+                    .base_instance = range_offsets[range],
+                });
+            }
+        }
+
+        instance_order.resize(object_indices.size());
+        for (std::uint32_t index : object_indices) {
+            instance_order[range_offsets[range_of(index)]++] = index;
+        }
+    }
+
+    [[nodiscard]] std::span<const DrawElementsIndirectCommand> getCommands() const noexcept {
+        return commands;
+    }
+
+    /**
+     * @brief Get the object index of each instance, in the order of the commands.
+     */
+    [[nodiscard]] std::span<const std::uint32_t> getInstanceOrder() const noexcept {
+        return instance_order;
+    }
+
+private:
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<std::uint32_t> instance_order;
+    std::vector<std::uint32_t> range_offsets; // Scratch buffer.
+};
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <optional>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float2.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
+
+struct AABB {
+    glm::vec3 min { std::numeric_limits<float>::max() };
+    glm::vec3 max { std::numeric_limits<float>::lowest() };
+
+    [[nodiscard]] glm::vec3 center() const noexcept {
+        return (min + max) * 0.5f;
+    }
+
+    [[nodiscard]] glm::vec3 extent() const noexcept {
+        return max - min;
+    }
+
+    void expand(const glm::vec3 &point) noexcept {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    void expand(const AABB &other) noexcept {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    /**
+     * @brief Get the world space AABB that encloses this AABB transformed by \p transform.
+     * @param transform Affine transformation matrix.
+     * @return Transformed AABB.
+     * @note It uses Arvo's method, which is cheaper than transforming all 8 corners.
+     */
+    [[nodiscard]] AABB transform(const glm::mat4 &transform) const noexcept {
+        AABB result { glm::vec3 { transform[3] }, glm::vec3 { transform[3] } };
+        for (int col = 0; col < 3; ++col) {
+            const glm::vec3 a = glm::vec3 { transform[col] } * min[col];
+            const glm::vec3 b = glm::vec3 { transform[col] } * max[col];
+            result.min += glm::min(a, b);
+            result.max += glm::max(a, b);
+        }
+        return result;
+    }
+};
+
+struct Frustum {
+    // Left, right, bottom, top, near, far. Normals point inward and are normalized, so dot(plane, (p, 1)) is the signed
+    // distance of p from the plane.
+    std::array<glm::vec4, 6> planes;
+
+    /**
+     * @brief Extract the world space frustum planes from the view-projection matrix (Gribb-Hartmann method).
+     * @param projection_view <tt>projection * view</tt>, with OpenGL clip space convention (z in [-w, w]).
+     */
+    [[nodiscard]] static Frustum fromMatrix(const glm::mat4 &projection_view) noexcept {
+        // Rows of the matrix (glm is column major).
+        const auto row = [&](int i) {
+            return glm::vec4 { projection_view[0][i], projection_view[1][i], projection_view[2][i], projection_view[3][i] };
+        };
+
+        Frustum frustum {
+            row(3) + row(0), row(3) - row(0),
+            row(3) + row(1), row(3) - row(1),
+            row(3) + row(2), row(3) - row(2),
+        };
+        for (glm::vec4 &plane : frustum.planes) {
+            plane /= length(glm::vec3 { plane });
+        }
+        return frustum;
+    }
+
+    /**
+     * @brief Test if the sphere is at least partially inside the frustum.
+     * @note It is conservative: spheres near the frustum corners may be reported as inside even if they are not.
+     */
+    [[nodiscard]] bool intersectSphere(const glm::vec3 &center, float radius) const noexcept {
+        return std::ranges::all_of(planes, [&](const glm::vec4 &plane) {
+            return dot(glm::vec3 { plane }, center) + plane.w >= -radius;
+        });
+    }
+};
+
+struct Ray {
+    glm::vec3 origin;
+    glm::vec3 direction;
+
+    /**
+     * @brief Get a ray that starts at the near plane and passes through the given NDC position.
+     * @param ndc Normalized device coordinate of the cursor, in [-1, 1]^2.
+     * @param inv_projection_view Inverse of <tt>projection * view</tt>.
+     * @return World space ray. Its direction is not normalized.
+     */
+    [[nodiscard]] static Ray fromNdc(const glm::vec2 &ndc, const glm::mat4 &inv_projection_view) noexcept {
+        const glm::vec4 near_point = inv_projection_view * glm::vec4 { ndc, -1.f, 1.f };
+        const glm::vec4 far_point = inv_projection_view * glm::vec4 { ndc, 1.f, 1.f };
+
+        const glm::vec3 origin = glm::vec3 { near_point } / near_point.w;
+        return { origin, glm::vec3 { far_point } / far_point.w - origin };
+    }
+
+    /**
+     * @brief Get the ray in the local space of the given transformation.
+     * @param inv_transform Inverse of the affine local-to-world matrix.
+     * @return Transformed ray. Its parameter \p t is preserved, i.e. <tt>origin + t * direction</tt> maps to the same
+     * point in both spaces, so intersection distances of different instances are comparable.
+     */
+    [[nodiscard]] Ray transform(const glm::mat4 &inv_transform) const noexcept {
+        return { glm::vec3 { inv_transform * glm::vec4 { origin, 1.f } }, glm::vec3 { inv_transform * glm::vec4 { direction, 0.f } } };
+    }
+
+    /**
+     * @brief Slab test against \p aabb.
+     * @param inv_direction Component-wise reciprocal of \p direction.
+     * @param aabb AABB to test.
+     * @param t_max Intersections farther than this are ignored.
+     * @return Ray parameter of the entry point, or \p std::nullopt if there is no intersection in <tt>[0, t_max]</tt>.
+     */
+    [[nodiscard]] std::optional<float> intersect(const glm::vec3 &inv_direction, const AABB &aabb, float t_max) const noexcept {
+        const glm::vec3 t0 = (aabb.min - origin) * inv_direction;
+        const glm::vec3 t1 = (aabb.max - origin) * inv_direction;
+        const glm::vec3 t_near = glm::min(t0, t1);
+        const glm::vec3 t_far = glm::max(t0, t1);
+
+        const float t_enter = std::max({ t_near.x, t_near.y, t_near.z, 0.f });
+        const float t_exit = std::min({ t_far.x, t_far.y, t_far.z, t_max });
+        if (t_enter <= t_exit) {
+            return t_enter;
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Möller–Trumbore ray/triangle intersection test. Both faces are tested.
+     * @return Ray parameter of the intersection point, or \p std::nullopt if there is no intersection in <tt>(0, t_max)</tt>.
+     */
+    [[nodiscard]] std::optional<float> intersect(const glm::vec3 &v0, const glm::vec3 &v1, const glm::vec3 &v2, float t_max) const noexcept {
+        constexpr float epsilon = 1e-8f;
+
+        const glm::vec3 edge1 = v1 - v0;
+        const glm::vec3 edge2 = v2 - v0;
+        const glm::vec3 p = cross(direction, edge2);
+        const float det = dot(edge1, p);
+        if (std::abs(det) < epsilon) {
+            return std::nullopt; // Ray is parallel to the triangle.
+        }
+
+        const float inv_det = 1.f / det;
+        const glm::vec3 s = origin - v0;
+        const float u = dot(s, p) * inv_det;
+        if (u < 0.f || u > 1.f) {
+            return std::nullopt;
+        }
+
+        const glm::vec3 q = cross(s, edge1);
+        const float v = dot(direction, q) * inv_det;
+        if (v < 0.f || u + v > 1.f) {
+            return std::nullopt;
+        }
+
+        const float t = dot(edge2, q) * inv_det;
+        if (t > 0.f && t < t_max) {
+            return t;
+        }
+        return std::nullopt;
+    }
+};
@@ -0,0 +1,93 @@
+#include "HiZBuffer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <limits>
+
+#include <glm/common.hpp>
+#include <glm/ext/vector_float4.hpp>
+
+namespace {
+    // Farthest depth of each 2x2 texels. Odd sized source's last row/column is clamped.
+    void downsample(std::span<const float> source, glm::ivec2 source_size, std::vector<float> &destination, glm::ivec2 destination_size) {
+        destination.resize(static_cast<std::size_t>(destination_size.x) * static_cast<std::size_t>(destination_size.y));
+        for (int y = 0; y < destination_size.y; ++y) {
+            const int y0 = 2 * y, y1 = std::min(y0 + 1, source_size.y - 1);
+            for (int x = 0; x < destination_size.x; ++x) {
+                const int x0 = 2 * x, x1 = std::min(x0 + 1, source_size.x - 1);
+                destination[y * destination_size.x + x] = std::max({
+                    source[y0 * source_size.x + x0], source[y0 * source_size.x + x1],
+                    source[y1 * source_size.x + x0], source[y1 * source_size.x + x1],
+                });
+            }
+        }
+    }
+}
+
+void HiZBuffer::build(std::span<const float> depths, glm::ivec2 size, const glm::mat4 &projection_view) {
+    assert(depths.size() == static_cast<std::size_t>(size.x) * static_cast<std::size_t>(size.y));
+
+    this->size = size;
+    this->projection_view = projection_view;
+
+    // Storages of the previous build are reused, if the size is not changed.
+    const std::size_t num_levels = std::bit_width(static_cast<unsigned>(std::max(size.x, size.y))) - 1;
+    levels.resize(std::max<std::size_t>(num_levels, 1));
+
+    std::span<const float> source = depths;
+    glm::ivec2 source_size = size;
+    for (Level &level : levels) {
+        level.size = glm::max((source_size + 1) / 2, glm::ivec2 { 1 });
+        downsample(source, source_size, level.depths, level.size);
+        source = level.depths;
+        source_size = level.size;
+    }
+}
+
+bool HiZBuffer::isOccluded(const glm::vec3 &center, float radius) const {
+    if (levels.empty()) {
+        return false;
+    }
+
+    // Window space bounds of the sphere's bounding box.
+    glm::vec2 window_min { std::numeric_limits<float>::max() }, window_max { std::numeric_limits<float>::lowest() };
+    float nearest_depth = std::numeric_limits<float>::max();
+    for (int corner = 0; corner < 8; ++corner) {
+        const glm::vec3 offset { corner & 1 ? radius : -radius, corner & 2 ? radius : -radius, corner & 4 ? radius : -radius };
+        const glm::vec4 clip = projection_view * glm::vec4 { center + offset, 1.f };
+        if (clip.w <= 0.f) {
+            return false; // Crossing the near plane, projection is not bounded.
+        }
+
+        const glm::vec3 ndc = glm::vec3 { clip } / clip.w;
+        const glm::vec2 window = (glm::vec2 { ndc } * 0.5f + 0.5f) * glm::vec2 { size };
+        window_min = glm::min(window_min, window);
+        window_max = glm::max(window_max, window);
+        nearest_depth = std::min(nearest_depth, ndc.z * 0.5f + 0.5f);
+    }
+
+    if (window_min.x < 0.f || window_min.y < 0.f || window_max.x >= static_cast<float>(size.x) || window_max.y >= static_cast<float>(size.y)) {
+        return false; // Partially outside of the depth buffer, whose depth is unknown.
+    }
+
+    // The finest level where the rectangle is no larger than a texel, so it covers at most 2x2 texels.
+    const float extent = std::max(window_max.x - window_min.x, window_max.y - window_min.y);
+    // Texel of levels[i] is 2^(i + 1) pixels large, and 2^bit_width(n) > n.
+    const std::size_t level_index = std::min<std::size_t>(
+        std::max<std::size_t>(std::bit_width(static_cast<unsigned>(extent)), 1) - 1,
+        levels.size() - 1);
+    const Level &level = levels[level_index];
+
+    const int texel_size = 2 << level_index;
+    const glm::ivec2 texel_min = glm::min(glm::ivec2 { window_min } / texel_size, level.size - 1);
+    const glm::ivec2 texel_max = glm::min(glm::ivec2 { window_max } / texel_size, level.size - 1);
+
+    float farthest_depth = 0.f;
+    for (int y = texel_min.y; y <= texel_max.y; ++y) {
+        for (int x = texel_min.x; x <= texel_max.x; ++x) {
+            farthest_depth = std::max(farthest_depth, level.depths[y * level.size.x + x]);
+        }
+    }
+    return nearest_depth > farthest_depth;
+}
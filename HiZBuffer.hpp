@@ -0,0 +1,53 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_int2.hpp>
+
+/**
+ * Hierarchical-Z buffer built on CPU from a depth buffer read back from the GPU, for occlusion culling.
+ *
+ * Each level stores the farthest depth of 2x2 texels of the previous one, so whether a bounding volume is hidden can
+ * be decided by reading at most 2x2 texels of the level where its screen rectangle is about one texel large. Since
+ * the depth buffer is read asynchronously, the volume is projected with the view-projection matrix of the frame where
+ * the depth was captured, not the current one.
+ */
+class HiZBuffer {
+public:
+    /**
+     * @brief Build the hierarchy from a depth buffer.
+     * @param depths Window space depths (in [0, 1]) of \p size pixels, in row major order from the bottom-left.
+     * @param size Size of the depth buffer.
+     * @param projection_view <tt>projection * view</tt> of the frame where the depth buffer was drawn.
+     */
+    void build(std::span<const float> depths, glm::ivec2 size, const glm::mat4 &projection_view);
+
+    void clear() noexcept {
+        levels.clear();
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return levels.empty();
+    }
+
+    /**
+     * @brief Test if the sphere is completely behind the depth buffer.
+     * @return \p true if the sphere is surely hidden. Spheres intersecting the near plane or outside the depth buffer are
+     * never reported as hidden.
+     */
+    [[nodiscard]] bool isOccluded(const glm::vec3 &center, float radius) const;
+
+private:
+    struct Level {
+        glm::ivec2 size;
+        std::vector<float> depths;
+    };
+
+    // levels[0] is the half resolution of the depth buffer, i.e. a texel of levels[i] covers 2^(i + 1) pixels per side.
+    std::vector<Level> levels;
+    glm::ivec2 size;
+    glm::mat4 projection_view;
+};
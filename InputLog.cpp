@@ -0,0 +1,86 @@
+#include "InputLog.hpp"
+
+#include <cstring>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "MappedFile.hpp"
+
+namespace {
+    static_assert(std::variant_size_v<InputLog::Event> <= 256);
+
+    template <typename T>
+    std::optional<T> readPayload(std::span<const std::byte> &bytes) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (bytes.size() < sizeof(T)) {
+            return std::nullopt;
+        }
+        T payload;
+        std::memcpy(&payload, bytes.data(), sizeof(T));
+        bytes = bytes.subspan(sizeof(T));
+        return payload;
+    }
+
+    // Alternative of the event is selected by the runtime index.
+    template <std::size_t... Is>
+    std::optional<InputLog::Event> readEvent(std::size_t type, std::span<const std::byte> &bytes, std::index_sequence<Is...>) {
+        std::optional<InputLog::Event> event;
+        ((type == Is && (event = readPayload<std::variant_alternative_t<Is, InputLog::Event>>(bytes), true)) || ...);
+        return event;
+    }
+}
+
+InputLog::InputLog(const std::filesystem::path &path) {
+    const MappedFile file { path };
+    std::span bytes = file.getBytes();
+    const std::optional read_header = readPayload<Header>(bytes);
+    if (!read_header || read_header->magic != magic) {
+        throw std::runtime_error { path.string() + " is not an input log" };
+    }
+    if (read_header->version != version) {
+        throw std::runtime_error { path.string() + " has unsupported version" };
+    }
+    header = *read_header;
+
+    while (!bytes.empty()) {
+        const auto type = static_cast<std::size_t>(bytes.front());
+        bytes = bytes.subspan(1);
+        std::optional event = readEvent(type, bytes, std::make_index_sequence<std::variant_size_v<Event>>{});
+        if (!event) {
+            throw std::runtime_error { path.string() + " is corrupted" };
+        }
+        events.push_back(*event);
+    }
+}
+
+InputRecorder::InputRecorder(const std::filesystem::path &path, std::uint32_t random_seed, float fixed_time_step)
+        : output { path, std::ios::binary },
+          random_seed { random_seed },
+          fixed_time_step { fixed_time_step }
+{
+    const InputLog::Header header { InputLog::magic, InputLog::version, random_seed, fixed_time_step };
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!output) {
+        throw std::runtime_error { "Failed to write " + path.string() };
+    }
+}
+
+void InputRecorder::record(const InputLog::Event &event) {
+    const auto type = static_cast<char>(event.index());
+    output.put(type);
+    std::visit([&]<typename T>(const T &payload) {
+        output.write(reinterpret_cast<const char*>(&payload), sizeof(T));
+    }, event);
+    if (!output) {
+        throw std::runtime_error { "Failed to write the input log" };
+    }
+}
+
+void InputRecorder::recordEndFrame(std::uint32_t hovered_index) {
+    const float timestamp = std::chrono::duration<float> { std::chrono::steady_clock::now() - start_time }.count();
+    record(InputLog::EndFrame { timestamp, hovered_index });
+    ++num_frames;
+}
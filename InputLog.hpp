@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <variant>
+#include <vector>
+
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_int2.hpp>
+
+#include "Scene.hpp"
+
+/**
+ * Binary log of every input of a \p Scene, recorded by \p InputRecorder and replayed by the \p input_replay tool. Since
+ * the rotation axes are generated from the recorded seed and the animation is advanced by the recorded time steps,
+ * replaying the log into a new scene reproduces the same frames, and the picked object of each frame can be compared.
+ *
+ * Layout (little endian):
+ * - \p Header.
+ * - Events, each of which is a 1-byte index of the alternative in \p Event followed by the alternative as-is.
+ */
+class InputLog {
+public:
+    static constexpr std::array<char, 4> magic { 'M', 'P', 'I', 'L' };
+    static constexpr std::uint32_t version = 2; // 2: Scene::Settings has the scene layout instead of the cube count.
+
+    struct Header {
+        std::array<char, 4> magic;
+        std::uint32_t version;
+        std::uint32_t random_seed;
+        float fixed_time_step; // Time step of the animation while recording, in seconds.
+    };
+
+    // Scene calls, in the order they were made.
+    struct Resize {
+        glm::ivec2 framebuffer_size;
+    };
+    struct Camera {
+        glm::mat4 view;
+        glm::mat4 projection;
+    };
+    struct Cursor {
+        glm::ivec2 position;
+        std::uint32_t on_scene; // 0 if the cursor left the scene.
+    };
+    struct SelectRegion {
+        glm::ivec2 corner1;
+        glm::ivec2 corner2;
+    };
+    struct ClearSelection {};
+    // Models are re-created with the seed.
+    struct Seed {
+        std::uint32_t random_seed;
+    };
+    struct Update {
+        float time_delta;
+    };
+    // Scene is drawn and the frame is ended.
+    struct EndFrame {
+        float timestamp; // Seconds since the recording started.
+        std::uint32_t hovered_index;
+    };
+
+    using Event = std::variant<Resize, Camera, Cursor, SelectRegion, ClearSelection, Seed, Scene::Settings, Update, EndFrame>;
+
+    /**
+     * @brief Read a log.
+     * @param path Path of the file.
+     * @throw std::runtime_error If the file cannot be read or it is not a valid log.
+     */
+    explicit InputLog(const std::filesystem::path &path);
+
+    [[nodiscard]] const Header &getHeader() const noexcept {
+        return header;
+    }
+
+    [[nodiscard]] const std::vector<Event> &getEvents() const noexcept {
+        return events;
+    }
+
+private:
+    Header header;
+    std::vector<Event> events;
+};
+
+/**
+ * Writer of \p InputLog. Set to a scene by \p Scene::setRecorder(), which records the calls while it is set.
+ *
+ * @code
+ * InputRecorder recorder { "input.log", scene.getRandomSeed(), 1.f / 60.f };
+ * scene.setRecorder(&recorder);
+ * // Run frames with scene.update(recorder.getFixedTimeStep()).
+ * scene.setRecorder(nullptr);
+ * @endcode
+ */
+class InputRecorder {
+public:
+    /**
+     * @param path Path of the log, which is overwritten.
+     * @param random_seed Seed of the rotation axes, which the scene is reset with.
+     * @param fixed_time_step Time step that the application advances the animation by.
+     * @throw std::runtime_error If the file cannot be opened.
+     */
+    InputRecorder(const std::filesystem::path &path, std::uint32_t random_seed, float fixed_time_step);
+
+    [[nodiscard]] std::uint32_t getRandomSeed() const noexcept {
+        return random_seed;
+    }
+
+    [[nodiscard]] float getFixedTimeStep() const noexcept {
+        return fixed_time_step;
+    }
+
+    [[nodiscard]] std::uint64_t getNumFrames() const noexcept {
+        return num_frames;
+    }
+
+    /**
+     * @throw std::runtime_error If the event cannot be written.
+     */
+    void record(const InputLog::Event &event);
+
+    /**
+     * @brief Record the end of a frame, timestamped from the construction.
+     * @throw std::runtime_error If the event cannot be written.
+     */
+    void recordEndFrame(std::uint32_t hovered_index);
+
+private:
+    std::ofstream output;
+    std::uint32_t random_seed;
+    float fixed_time_step;
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+    std::uint64_t num_frames = 0;
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include <glm/ext/matrix_float3x3.hpp>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <OGLWrapper/Helper/VertexAttributes.hpp>
+
+/**
+ * Per-instance attributes for instanced rendering. \p normal_matrix is the inverse transpose of the upper-left 3x3
+ * of \p model, so vertex shader doesn't have to compute the inverse for every vertex. \p object_id is the index of the
+ * instance in the whole scene, which differs from \p gl_InstanceID when only the visible instances are drawn.
+ * \p material_index selects the layer of the material texture arrays.
+ */
+struct InstanceData {
+    glm::mat4 model;
+    glm::mat3 normal_matrix;
+    std::uint32_t object_id;
+    std::uint32_t material_index;
+};
+static_assert(std::is_standard_layout_v<InstanceData>);
+
+template <>
+struct OGLWrapper::Helper::VertexAttributes<InstanceData> {
+    GLuint model; // Occupies 4 consecutive locations.
+    GLuint normal_matrix; // Occupies 3 consecutive locations.
+    GLuint object_id;
+    GLuint material_index;
+
+    /**
+     * @param first_instance Index of the instance in the bound buffer, which is sourced by the first instance of a draw
+     * call.
+     */
+    void setVertexAttribArrays(std::size_t first_instance = 0) const {
+        const std::size_t base_offset = sizeof(InstanceData) * first_instance;
+
+        // Matrix attributes are passed column by column, and advanced once per instance.
+        for (GLuint column = 0; column < 4; ++column) {
+            glEnableVertexAttribArray(model + column);
+            glVertexAttribPointer(
+                model + column,
+                4,
+                GL_FLOAT,
+                GL_FALSE,
+                sizeof(InstanceData),
+                reinterpret_cast<const void*>(base_offset + offsetof(InstanceData, model) + sizeof(glm::vec4) * column));
+            glVertexAttribDivisor(model + column, 1);
+        }
+
+        for (GLuint column = 0; column < 3; ++column) {
+            glEnableVertexAttribArray(normal_matrix + column);
+            glVertexAttribPointer(
+                normal_matrix + column,
+                3,
+                GL_FLOAT,
+                GL_FALSE,
+                sizeof(InstanceData),
+                reinterpret_cast<const void*>(base_offset + offsetof(InstanceData, normal_matrix) + sizeof(glm::vec3) * column));
+            glVertexAttribDivisor(normal_matrix + column, 1);
+        }
+
+        // Integer attributes must not be converted to float.
+        glEnableVertexAttribArray(object_id);
+        glVertexAttribIPointer(object_id, 1, GL_UNSIGNED_INT, sizeof(InstanceData), reinterpret_cast<const void*>(base_offset + offsetof(InstanceData, object_id)));
+        glVertexAttribDivisor(object_id, 1);
+
+        glEnableVertexAttribArray(material_index);
+        glVertexAttribIPointer(material_index, 1, GL_UNSIGNED_INT, sizeof(InstanceData), reinterpret_cast<const void*>(base_offset + offsetof(InstanceData, material_index)));
+        glVertexAttribDivisor(material_index, 1);
+    }
+};
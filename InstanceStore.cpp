@@ -0,0 +1,210 @@
+#include "InstanceStore.hpp"
+
+#include <bit>
+#include <cassert>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define INSTANCE_STORE_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+#ifdef INSTANCE_STORE_USE_SSE
+    // Thin wrapper of __m128 to share the kernel with the scalar code path.
+    struct Float4 {
+        __m128 v;
+
+        Float4(__m128 v) : v { v } { }
+        Float4(float s) : v { _mm_set1_ps(s) } { }
+
+        friend Float4 operator+(Float4 lhs, Float4 rhs) { return _mm_add_ps(lhs.v, rhs.v); }
+        friend Float4 operator-(Float4 lhs, Float4 rhs) { return _mm_sub_ps(lhs.v, rhs.v); }
+        friend Float4 operator*(Float4 lhs, Float4 rhs) { return _mm_mul_ps(lhs.v, rhs.v); }
+
+        // Comparison results have all bits set in the lanes where true.
+        friend Float4 operator<(Float4 lhs, Float4 rhs) { return _mm_cmplt_ps(lhs.v, rhs.v); }
+        friend Float4 operator|(Float4 lhs, Float4 rhs) { return _mm_or_ps(lhs.v, rhs.v); }
+
+        // Sign bits of the lanes, i.e. bit i is set if lane i of a comparison result is true.
+        [[nodiscard]] int mask() const { return _mm_movemask_ps(v); }
+
+        static Float4 load(const float *p) { return _mm_loadu_ps(p); }
+        void store(float *p) const { _mm_storeu_ps(p, v); }
+    };
+
+    Float4 inverseSqrt(Float4 x) {
+        // _mm_rsqrt_ps is only 12-bit accurate, and its error would be visible as a scale of the model.
+        return _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(x.v));
+    }
+#endif
+
+    float inverseSqrt(float x) {
+        return 1.f / std::sqrt(x);
+    }
+
+    template <typename V>
+    struct Rotation {
+        V m00, m01, m02, m10, m11, m12, m20, m21, m22; // m{column}{row}, same as glm.
+    };
+
+    /**
+     * Integrate the orientation by dq/dt = q * (0, w) / 2, where w is the local space angular velocity, and get the
+     * rotation matrix of the new orientation.
+     */
+    template <typename V>
+    Rotation<V> integrateOrientation(V &qx, V &qy, V &qz, V &qw, V wx, V wy, V wz, V half_dt) {
+        const V dx = qw * wx + qy * wz - qz * wy;
+        const V dy = qw * wy + qz * wx - qx * wz;
+        const V dz = qw * wz + qx * wy - qy * wx;
+        const V dw = V { 0.f } - (qx * wx + qy * wy + qz * wz);
+
+        qx = qx + half_dt * dx;
+        qy = qy + half_dt * dy;
+        qz = qz + half_dt * dz;
+        qw = qw + half_dt * dw;
+
+        // Renormalize to not accumulate the integration error.
+        const V inv_length = inverseSqrt(qx * qx + qy * qy + qz * qz + qw * qw);
+        qx = qx * inv_length;
+        qy = qy * inv_length;
+        qz = qz * inv_length;
+        qw = qw * inv_length;
+
+        // Same as glm::mat3_cast.
+        const V xx = qx * qx, yy = qy * qy, zz = qz * qz;
+        const V xy = qx * qy, xz = qx * qz, yz = qy * qz;
+        const V wx_ = qw * qx, wy_ = qw * qy, wz_ = qw * qz;
+        const V one { 1.f }, two { 2.f };
+        return {
+            one - two * (yy + zz), two * (xy + wz_), two * (xz - wy_),
+            two * (xy - wz_), one - two * (xx + zz), two * (yz + wx_),
+            two * (xz + wy_), two * (yz - wx_), one - two * (xx + yy),
+        };
+    }
+
+    void writeInstanceData(InstanceData &output, std::size_t index, std::uint32_t material_index, const Rotation<float> &r, float px, float py, float pz) {
+        output.model = glm::mat4 {
+            glm::vec4 { r.m00, r.m01, r.m02, 0.f },
+            glm::vec4 { r.m10, r.m11, r.m12, 0.f },
+            glm::vec4 { r.m20, r.m21, r.m22, 0.f },
+            glm::vec4 { px, py, pz, 1.f },
+        };
+        output.normal_matrix = glm::mat3 {
+            glm::vec3 { r.m00, r.m01, r.m02 },
+            glm::vec3 { r.m10, r.m11, r.m12 },
+            glm::vec3 { r.m20, r.m21, r.m22 },
+        };
+        output.object_id = static_cast<std::uint32_t>(index);
+        output.material_index = material_index;
+    }
+}
+
+void InstanceStore::clear() noexcept {
+    for (auto *array : { &position_x, &position_y, &position_z,
+                         &orientation_x, &orientation_y, &orientation_z, &orientation_w,
+                         &angular_velocity_x, &angular_velocity_y, &angular_velocity_z }) {
+        array->clear();
+    }
+    material_indices.clear();
+}
+
+void InstanceStore::reserve(std::size_t capacity) {
+    for (auto *array : { &position_x, &position_y, &position_z,
+                         &orientation_x, &orientation_y, &orientation_z, &orientation_w,
+                         &angular_velocity_x, &angular_velocity_y, &angular_velocity_z }) {
+        array->reserve(capacity);
+    }
+    material_indices.reserve(capacity);
+}
+
+void InstanceStore::push_back(const glm::vec3 &position, const glm::quat &orientation, const glm::vec3 &angular_velocity, std::uint32_t material_index) {
+    position_x.push_back(position.x);
+    position_y.push_back(position.y);
+    position_z.push_back(position.z);
+    orientation_x.push_back(orientation.x);
+    orientation_y.push_back(orientation.y);
+    orientation_z.push_back(orientation.z);
+    orientation_w.push_back(orientation.w);
+    angular_velocity_x.push_back(angular_velocity.x);
+    angular_velocity_y.push_back(angular_velocity.y);
+    angular_velocity_z.push_back(angular_velocity.z);
+    material_indices.push_back(material_index);
+}
+
+void InstanceStore::update(float time_delta, std::size_t first, std::size_t last, std::span<InstanceData> output) {
+    assert(first <= last && last <= size() && last <= output.size());
+
+    const float half_dt = 0.5f * time_delta;
+    std::size_t i = first;
+
+#ifdef INSTANCE_STORE_USE_SSE
+    for (; i + 4 <= last; i += 4) {
+        Float4 qx = Float4::load(&orientation_x[i]), qy = Float4::load(&orientation_y[i]),
+               qz = Float4::load(&orientation_z[i]), qw = Float4::load(&orientation_w[i]);
+        const Rotation<Float4> r = integrateOrientation(
+            qx, qy, qz, qw,
+            Float4::load(&angular_velocity_x[i]), Float4::load(&angular_velocity_y[i]), Float4::load(&angular_velocity_z[i]),
+            Float4 { half_dt });
+        qx.store(&orientation_x[i]);
+        qy.store(&orientation_y[i]);
+        qz.store(&orientation_z[i]);
+        qw.store(&orientation_w[i]);
+
+        // Transpose the lanes into the interleaved output.
+        alignas(16) float lanes[9][4];
+        const Float4 *components[] = { &r.m00, &r.m01, &r.m02, &r.m10, &r.m11, &r.m12, &r.m20, &r.m21, &r.m22 };
+        for (std::size_t c = 0; c < 9; ++c) {
+            components[c]->store(lanes[c]);
+        }
+        for (std::size_t lane = 0; lane < 4; ++lane) {
+            const Rotation<float> lane_r {
+                lanes[0][lane], lanes[1][lane], lanes[2][lane],
+                lanes[3][lane], lanes[4][lane], lanes[5][lane],
+                lanes[6][lane], lanes[7][lane], lanes[8][lane],
+            };
+            writeInstanceData(output[i + lane], i + lane, material_indices[i + lane], lane_r, position_x[i + lane], position_y[i + lane], position_z[i + lane]);
+        }
+    }
+#endif
+
+    // Remainder of SIMD loop, or whole range if SSE is not available (compiler may auto-vectorize it).
+    for (; i < last; ++i) {
+        const Rotation<float> r = integrateOrientation(
+            orientation_x[i], orientation_y[i], orientation_z[i], orientation_w[i],
+            angular_velocity_x[i], angular_velocity_y[i], angular_velocity_z[i],
+            half_dt);
+        writeInstanceData(output[i], i, material_indices[i], r, position_x[i], position_y[i], position_z[i]);
+    }
+}
+
+void InstanceStore::cullSpheres(const Frustum &frustum, float radius, std::span<const float> xs, std::span<const float> ys, std::span<const float> zs, std::vector<std::uint32_t> &visible_indices) {
+    assert(xs.size() == ys.size() && ys.size() == zs.size());
+    const std::size_t count = xs.size();
+    std::size_t i = 0;
+
+#ifdef INSTANCE_STORE_USE_SSE
+    const Float4 negative_radius { -radius };
+    for (; i + 4 <= count; i += 4) {
+        const Float4 x = Float4::load(&xs[i]), y = Float4::load(&ys[i]), z = Float4::load(&zs[i]);
+
+        // A sphere is outside if it is completely behind any plane.
+        Float4 outside { _mm_setzero_ps() };
+        for (const glm::vec4 &plane : frustum.planes) {
+            const Float4 distance = Float4 { plane.x } * x + Float4 { plane.y } * y + Float4 { plane.z } * z + Float4 { plane.w };
+            outside = outside | (distance < negative_radius);
+        }
+
+        for (int visible_mask = ~outside.mask() & 0xF; visible_mask != 0; visible_mask &= visible_mask - 1) {
+            visible_indices.push_back(static_cast<std::uint32_t>(i + std::countr_zero(static_cast<unsigned>(visible_mask))));
+        }
+    }
+#endif
+
+    // Remainder of SIMD loop, or whole spheres if SSE is not available.
+    for (; i < count; ++i) {
+        if (frustum.intersectSphere({ xs[i], ys[i], zs[i] }, radius)) {
+            visible_indices.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/ext/quaternion_float.hpp>
+#include <glm/ext/vector_float3.hpp>
+
+#include "AlignedAllocator.hpp"
+#include "Geometry.hpp"
+#include "InstanceData.hpp"
+
+/**
+ * Structure-of-arrays storage of rigidly rotating instances. Each component is stored in its own aligned array, so that
+ * \p update() processes four instances at once with SSE (or lets the compiler auto-vectorize the scalar loop on other
+ * architectures).
+ *
+ * Instead of building an arbitrary-axis rotation matrix per instance (as \p glm::rotate does), the orientation
+ * quaternion is integrated with its time derivative and renormalized, which needs neither trigonometric functions nor
+ * matrix multiplication. Since instances are not scaled, the normal matrix is the rotation matrix itself.
+ */
+class InstanceStore {
+public:
+    static constexpr std::size_t alignment = 32;
+
+    template <typename T>
+    using aligned_vector = std::vector<T, AlignedAllocator<T, alignment>>;
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return position_x.size();
+    }
+
+    void clear() noexcept;
+    void reserve(std::size_t capacity);
+
+    /**
+     * @brief Add an instance.
+     * @param position World space position.
+     * @param orientation Unit quaternion of the initial orientation.
+     * @param angular_velocity Local space rotation axis multiplied by the angular speed (radian per second).
+     * @param material_index Index of the material in \p MaterialRegistry, written to \p InstanceData::material_index.
+     */
+    void push_back(const glm::vec3 &position, const glm::quat &orientation, const glm::vec3 &angular_velocity, std::uint32_t material_index = 0);
+
+    /**
+     * @brief Rotate the instances in <tt>[first, last)</tt> by their angular velocity for \p time_delta seconds, and write
+     * their model and normal matrices.
+     * @param time_delta Elapsed time in seconds.
+     * @param first, last Range of the instance indices.
+     * @param output Output for the whole instances. Only <tt>output[first, last)</tt> is written.
+     * @note Different ranges can be updated concurrently.
+     */
+    void update(float time_delta, std::size_t first, std::size_t last, std::span<InstanceData> output);
+
+    void update(float time_delta, std::span<InstanceData> output) {
+        update(time_delta, 0, size(), output);
+    }
+
+    /**
+     * @brief Test the bounding spheres of the instances against \p frustum, four instances at once with SSE, and append
+     * the indices of the ones at least partially inside to \p visible_indices in ascending order.
+     * @param frustum World space frustum.
+     * @param radius Bounding sphere radius, shared by every instance. Spheres are centered at the instance positions, so
+     * it is valid regardless of the orientation.
+     * @param visible_indices Output indices.
+     */
+    void cullSpheres(const Frustum &frustum, float radius, std::vector<std::uint32_t> &visible_indices) const {
+        cullSpheres(frustum, radius, position_x, position_y, position_z, visible_indices);
+    }
+
+    /**
+     * @brief Same as above, but for the sphere centers given as separate coordinate arrays of the same size, e.g. world
+     * space positions of a hierarchy.
+     */
+    static void cullSpheres(const Frustum &frustum, float radius, std::span<const float> xs, std::span<const float> ys, std::span<const float> zs, std::vector<std::uint32_t> &visible_indices);
+
+private:
+    aligned_vector<float> position_x, position_y, position_z;
+    aligned_vector<float> orientation_x, orientation_y, orientation_z, orientation_w;
+    aligned_vector<float> angular_velocity_x, angular_velocity_y, angular_velocity_z;
+    std::vector<std::uint32_t> material_indices;
+};
@@ -0,0 +1,96 @@
+#include "JobSystem.hpp"
+
+namespace {
+    // Which job system and queue the current thread owns. Non-worker threads have no owner.
+    thread_local const JobSystem *current_job_system = nullptr;
+    thread_local std::size_t current_queue_index = 0;
+}
+
+JobSystem::JobSystem(std::size_t num_threads) {
+    const std::size_t num_workers = num_threads > 1 ? num_threads - 1 : 0;
+    for (std::size_t i = 0; i < num_workers + 1; ++i) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    workers.reserve(num_workers);
+    for (std::size_t i = 0; i < num_workers; ++i) {
+        workers.emplace_back(std::bind_front(&JobSystem::workerLoop, this), i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    for (std::jthread &worker : workers) {
+        worker.request_stop();
+    }
+    sleep_condition.notify_all();
+    // std::jthread joins on destruction.
+    workers.clear();
+
+    // Jobs still queued (including the ones submitted by the last jobs of the workers) are not dropped.
+    while (tryExecuteOne()) { }
+}
+
+void JobSystem::submit(Job job) {
+    const std::size_t queue_index = getCurrentQueueIndex();
+    {
+        std::lock_guard lock { queues[queue_index]->mutex };
+        queues[queue_index]->jobs.push_back(std::move(job));
+    }
+    num_queued_jobs.fetch_add(1, std::memory_order_release);
+
+    // Lock to not lose the wakeup of a worker that just checked the predicate.
+    { std::lock_guard lock { sleep_mutex }; }
+    sleep_condition.notify_one();
+}
+
+void JobSystem::workerLoop(std::stop_token stop_token, std::size_t queue_index) {
+    current_job_system = this;
+    current_queue_index = queue_index;
+
+    while (!stop_token.stop_requested()) {
+        if (tryExecuteOne()) {
+            continue;
+        }
+
+        std::unique_lock lock { sleep_mutex };
+        sleep_condition.wait(lock, stop_token, [&]() {
+            return num_queued_jobs.load(std::memory_order_acquire) != 0;
+        });
+    }
+}
+
+bool JobSystem::tryExecuteOne() {
+    const std::size_t own_index = getCurrentQueueIndex();
+
+    Job job;
+    for (std::size_t i = 0; i < queues.size() && !job; ++i) {
+        WorkQueue &queue = *queues[(own_index + i) % queues.size()];
+        std::lock_guard lock { queue.mutex };
+        if (queue.jobs.empty()) {
+            continue;
+        }
+
+        if (i == 0) {
+            // Own queue: newest job, whose data is likely still in cache.
+            job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+        }
+        else {
+            // Steal the oldest job, which tends to be the largest remaining work.
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+        }
+    }
+
+    if (!job) {
+        return false;
+    }
+
+    num_queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+    job();
+    return true;
+}
+
+std::size_t JobSystem::getCurrentQueueIndex() const noexcept {
+    return current_job_system == this ? current_queue_index : queues.size() - 1;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed-size thread pool with per-thread work-stealing queues.
+ *
+ * Each worker pops the most recently pushed job from its own queue (LIFO, cache friendly), and steals the oldest job
+ * from the other queues when its own is empty. The thread that calls \p parallelFor() also executes the jobs until its
+ * range is finished, so that it never idles while waiting.
+ *
+ * @code
+ * JobSystem job_system; // Sized to the hardware concurrency.
+ * job_system.parallelFor(0, values.size(), 1024, [&](std::size_t first, std::size_t last) {
+ *     for (std::size_t i = first; i < last; ++i) {
+ *         values[i] *= 2;
+ *     }
+ * });
+ * // All values are doubled here.
+ * @endcode
+ */
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+
+    /**
+     * @brief Create the job system.
+     * @param num_threads Number of threads that execute the jobs, including the calling thread of \p parallelFor().
+     * Therefore <tt>num_threads - 1</tt> workers are spawned. Defaults to the hardware concurrency.
+     */
+    explicit JobSystem(std::size_t num_threads = std::max(std::thread::hardware_concurrency(), 1U));
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem &operator=(const JobSystem&) = delete;
+
+    [[nodiscard]] std::size_t getNumThreads() const noexcept {
+        return workers.size() + 1;
+    }
+
+    /**
+     * @brief Push a job to be executed by any thread.
+     * @param job Job to execute. It must not throw.
+     * @note Jobs that are not executed yet when the job system is destroyed are executed by the destructor.
+     */
+    void submit(Job job);
+
+    /**
+     * @brief Split <tt>[first, last)</tt> into chunks of at most \p grain_size, execute \p f for every chunk in parallel,
+     * and wait for all of them.
+     * @param first, last Range to process.
+     * @param grain_size Maximum size of a chunk.
+     * @param f Invoked as <tt>f(chunk_first, chunk_last)</tt>. It must not throw.
+     */
+    template <typename F>
+    void parallelFor(std::size_t first, std::size_t last, std::size_t grain_size, F &&f) {
+        if (last <= first) {
+            return;
+        }
+        if (last - first <= grain_size || workers.empty()) {
+            f(first, last); // Not worth to distribute.
+            return;
+        }
+
+        std::atomic<std::size_t> num_remaining_chunks { (last - first + grain_size - 1) / grain_size };
+        for (std::size_t chunk_first = first; chunk_first < last; chunk_first += grain_size) {
+            const std::size_t chunk_last = std::min(chunk_first + grain_size, last);
+            submit([&, chunk_first, chunk_last]() {
+                f(chunk_first, chunk_last);
+                num_remaining_chunks.fetch_sub(1, std::memory_order_release);
+            });
+        }
+
+        // Help executing the jobs instead of blocking.
+        while (num_remaining_chunks.load(std::memory_order_acquire) != 0) {
+            if (!tryExecuteOne()) {
+                std::this_thread::yield(); // Remaining chunks are being executed by other threads.
+            }
+        }
+    }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    // queues[i] is owned by workers[i], and the last one is shared by the other threads.
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::jthread> workers;
+
+    std::atomic<std::size_t> num_queued_jobs = 0;
+    std::mutex sleep_mutex;
+    std::condition_variable_any sleep_condition;
+
+    void workerLoop(std::stop_token stop_token, std::size_t queue_index);
+    bool tryExecuteOne();
+
+    [[nodiscard]] std::size_t getCurrentQueueIndex() const noexcept;
+};
@@ -0,0 +1,81 @@
+#include "MappedFile.hpp"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::filesystem::path &path) {
+    file_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error { "Failed to open " + path.string() };
+    }
+
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(file_handle, &file_size);
+    size = static_cast<std::size_t>(file_size.QuadPart);
+    if (size == 0) {
+        return; // Empty file cannot be mapped.
+    }
+
+    mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping_handle) {
+        CloseHandle(file_handle);
+        throw std::runtime_error { "Failed to map " + path.string() };
+    }
+    data = static_cast<const std::byte*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    if (!data) {
+        CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+        throw std::runtime_error { "Failed to map " + path.string() };
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (data) {
+        UnmapViewOfFile(data);
+    }
+    if (mapping_handle) {
+        CloseHandle(mapping_handle);
+    }
+    if (file_handle) {
+        CloseHandle(file_handle);
+    }
+}
+#else
+MappedFile::MappedFile(const std::filesystem::path &path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        throw std::runtime_error { "Failed to open " + path.string() };
+    }
+
+    struct stat file_stat {};
+    fstat(fd, &file_stat);
+    size = static_cast<std::size_t>(file_stat.st_size);
+    if (size == 0) {
+        close(fd);
+        return; // Empty file cannot be mapped.
+    }
+
+    void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // Mapping remains valid after the descriptor is closed.
+    if (mapped == MAP_FAILED) {
+        throw std::runtime_error { "Failed to map " + path.string() };
+    }
+    data = static_cast<const std::byte*>(mapped);
+}
+
+MappedFile::~MappedFile() {
+    if (data) {
+        munmap(const_cast<std::byte*>(data), size);
+    }
+}
+#endif
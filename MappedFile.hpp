@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <utility>
+
+/**
+ * Read-only memory mapped file. Pages are loaded by the OS on first access, so that the content can be used (e.g.
+ * uploaded to GPU) without copying it into an intermediate buffer.
+ */
+class MappedFile {
+    const std::byte *data = nullptr;
+    std::size_t size = 0;
+#ifdef _WIN32
+    void *file_handle = nullptr;
+    void *mapping_handle = nullptr;
+#endif
+
+public:
+    /**
+     * @brief Map the whole file.
+     * @param path Path of the file.
+     * @throw std::runtime_error If the file cannot be opened or mapped.
+     */
+    explicit MappedFile(const std::filesystem::path &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile &operator=(const MappedFile&) = delete;
+
+    // Mapped address is not changed by move, so pointers into the content remain valid.
+    MappedFile(MappedFile &&other) noexcept
+        : data { std::exchange(other.data, nullptr) }, size { std::exchange(other.size, 0) }
+#ifdef _WIN32
+        , file_handle { std::exchange(other.file_handle, nullptr) }, mapping_handle { std::exchange(other.mapping_handle, nullptr) }
+#endif
+    {
+
+    }
+
+    [[nodiscard]] std::span<const std::byte> getBytes() const noexcept {
+        return { data, size };
+    }
+};
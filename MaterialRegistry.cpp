@@ -0,0 +1,174 @@
+#include "MaterialRegistry.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    std::size_t getMaxLayerCount() {
+        GLint max_layers;
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_layers);
+        return static_cast<std::size_t>(max_layers);
+    }
+
+    bool isLayoutCompatible(const TextureFile::Header &lhs, const TextureFile::Header &rhs) {
+        return lhs.format == rhs.format && lhs.level_count == rhs.level_count
+            && lhs.levels[0].width == rhs.levels[0].width && lhs.levels[0].height == rhs.levels[0].height;
+    }
+}
+
+MaterialRegistry::TextureArray::TextureArray(glm::u8vec4 placeholder_color) {
+    glGenTextures(1, &placeholder);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, placeholder);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, 1, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &placeholder_color);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+MaterialRegistry::TextureArray::~TextureArray() {
+    if (texture) {
+        glDeleteTextures(1, &texture);
+    }
+    glDeleteTextures(1, &placeholder);
+}
+
+const TextureFile::Header *MaterialRegistry::TextureArray::findHeader() const noexcept {
+    const auto it = std::ranges::find_if(layers, [](const std::optional<TextureFile> &layer) { return layer.has_value(); });
+    return it == layers.end() ? nullptr : &(*it)->getHeader();
+}
+
+void MaterialRegistry::TextureArray::allocate(std::size_t new_capacity) {
+    if (texture) {
+        glDeleteTextures(1, &texture);
+    }
+    glGenTextures(1, &texture);
+    capacity = new_capacity;
+
+    // Every level is allocated for the whole layers without data, and filled by upload().
+    const TextureFile::Header &header = *findHeader();
+    const GLenum internal_format = TextureFile::getInternalFormat(header.format);
+    const auto depth = static_cast<GLsizei>(capacity);
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    for (std::uint32_t level = 0; level < header.level_count; ++level) {
+        const auto width = static_cast<GLsizei>(header.levels[level].width);
+        const auto height = static_cast<GLsizei>(header.levels[level].height);
+        if (header.format == TextureFile::Format::Rgba8) {
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, static_cast<GLint>(level), GL_RGBA8, width, height, depth, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        }
+        else {
+            const auto image_size = static_cast<GLsizei>(header.levels[level].size * capacity);
+            glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, static_cast<GLint>(level), internal_format, width, height, depth, 0, image_size, nullptr);
+        }
+    }
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(header.level_count) - 1);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void MaterialRegistry::TextureArray::upload(std::size_t layer) const {
+    const TextureFile &file = *layers[layer];
+    const TextureFile::Header &header = file.getHeader();
+    const GLenum internal_format = TextureFile::getInternalFormat(header.format);
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    for (std::uint32_t level = 0; level < header.level_count; ++level) {
+        const auto width = static_cast<GLsizei>(header.levels[level].width);
+        const auto height = static_cast<GLsizei>(header.levels[level].height);
+        const std::span data = file.getLevelData(level);
+        if (header.format == TextureFile::Format::Rgba8) {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, static_cast<GLint>(level), 0, 0, static_cast<GLint>(layer), width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
+        }
+        else {
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, static_cast<GLint>(level), 0, 0, static_cast<GLint>(layer), width, height, 1, internal_format, static_cast<GLsizei>(data.size()), data.data());
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void MaterialRegistry::TextureArray::bind() const {
+    // Unset layers have undefined content, so the placeholder is used until every layer is set.
+    glBindTexture(GL_TEXTURE_2D_ARRAY, isComplete() ? texture : placeholder);
+}
+
+void MaterialRegistry::TextureArray::validate(const TextureFile &file, const std::filesystem::path &source_path) const {
+    if (const TextureFile::Header *header = findHeader(); header && !isLayoutCompatible(*header, file.getHeader())) {
+        throw std::runtime_error { source_path.string() + " differs in size or format from the other maps of the texture array" };
+    }
+}
+
+std::size_t MaterialRegistry::TextureArray::reserveLayer() {
+    layers.emplace_back();
+    return layers.size() - 1;
+}
+
+void MaterialRegistry::TextureArray::set(std::size_t layer, TextureFile file) {
+    layers[layer].emplace(std::move(file));
+    ++num_set_layers;
+    if (layers.size() > capacity) {
+        // Existing layers are uploaded again from the mapped files, instead of copying between textures which needs
+        // OpenGL 4.3.
+        allocate(std::min<std::size_t>(std::max<std::size_t>(2 * capacity, std::max<std::size_t>(layers.size(), 4)), getMaxLayerCount()));
+        for (std::size_t i = 0; i < layers.size(); ++i) {
+            if (layers[i]) {
+                upload(i);
+            }
+        }
+    }
+    else {
+        upload(layer);
+    }
+}
+
+MaterialRegistry::MaterialRegistry(TextureCache &texture_cache) : texture_cache { texture_cache } {
+
+}
+
+std::uint32_t MaterialRegistry::add(const std::filesystem::path &diffuse_path, const std::filesystem::path &specular_path) {
+    TextureFile diffuse_file = texture_cache.loadFile(diffuse_path);
+    TextureFile specular_file = texture_cache.loadFile(specular_path);
+
+    // Both maps are validated before modifying any array, so that the arrays always have the same layer count.
+    diffuse_maps.validate(diffuse_file, diffuse_path);
+    specular_maps.validate(specular_file, specular_path);
+    const std::uint32_t index = reserveMaterial();
+    diffuse_maps.set(index, std::move(diffuse_file));
+    specular_maps.set(index, std::move(specular_file));
+    return index;
+}
+
+std::uint32_t MaterialRegistry::addAsync(AssetLoader &asset_loader, const std::filesystem::path &diffuse_path, const std::filesystem::path &specular_path) {
+    const std::uint32_t index = reserveMaterial();
+
+    // Each map is a separate load, so that both are converted in parallel at the cache miss.
+    const auto load_map = [&](TextureArray &maps, const std::filesystem::path &path) {
+        asset_loader.load(
+            [this, path]() { return texture_cache.loadFile(path); },
+            [&maps, index, path](TextureFile &file) {
+                maps.validate(file, path);
+                maps.set(index, std::move(file));
+            });
+    };
+    load_map(diffuse_maps, diffuse_path);
+    load_map(specular_maps, specular_path);
+    return index;
+}
+
+void MaterialRegistry::bind(GLenum diffuse_unit, GLenum specular_unit) const {
+    glActiveTexture(diffuse_unit);
+    diffuse_maps.bind();
+    glActiveTexture(specular_unit);
+    specular_maps.bind();
+}
+
+std::uint32_t MaterialRegistry::reserveMaterial() {
+    if (size() == getMaxLayerCount()) {
+        throw std::runtime_error { "Too many materials" };
+    }
+    diffuse_maps.reserveLayer();
+    return static_cast<std::uint32_t>(specular_maps.reserveLayer());
+}
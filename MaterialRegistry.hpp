@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <numeric>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include <GL/gl3w.h>
+#include <glm/vec4.hpp>
+
+#include "AssetLoader.hpp"
+#include "TextureCache.hpp"
+#include "TextureFile.hpp"
+
+/**
+ * Registry of materials, whose diffuse and specular maps are packed into the layers of two \p GL_TEXTURE_2D_ARRAY
+ * textures. Index of a material is the layer of its maps, so both arrays are bound once for the whole scene, and a single
+ * instanced draw call can render instances of different materials (shader selects the layer by the per-instance
+ * material index).
+ *
+ * Layers of an array share the size and the format, so every diffuse (or specular) map must be converted by
+ * \p TextureCache from the images of the same size and the same opacity.
+ *
+ * Materials added by \p addAsync() get their index immediately, and are drawn with a placeholder (gray diffuse, no
+ * specular) until every map is uploaded.
+ *
+ * @code
+ * MaterialRegistry materials { texture_cache };
+ * const std::uint32_t wood = materials.addAsync(asset_loader, "container2.png", "container2_specular.png");
+ * // Every frame.
+ * asset_loader.processUploads(budget_ms);
+ * materials.bind(GL_TEXTURE0, GL_TEXTURE1);
+ * // Draw with sampler2DArray uniforms set to texture unit 0 and 1.
+ * @endcode
+ */
+class MaterialRegistry {
+public:
+    explicit MaterialRegistry(TextureCache &texture_cache);
+
+    MaterialRegistry(const MaterialRegistry&) = delete;
+    MaterialRegistry &operator=(const MaterialRegistry&) = delete;
+
+    /**
+     * @brief Register a material, whose maps are loaded through the texture cache and uploaded into the new layers.
+     * @param diffuse_path, specular_path Paths of the images.
+     * @return Index of the material.
+     * @throw std::runtime_error If the maps cannot be loaded, their size or format differs from the registered maps, or
+     * there are more materials than \p GL_MAX_ARRAY_TEXTURE_LAYERS.
+     */
+    std::uint32_t add(const std::filesystem::path &diffuse_path, const std::filesystem::path &specular_path);
+
+    /**
+     * @brief Register a material, whose maps are loaded through the texture cache by \p asset_loader, and uploaded into
+     * the new layers when \p asset_loader processes the uploads.
+     * @param asset_loader Loader that is destroyed before this registry.
+     * @param diffuse_path, specular_path Paths of the images.
+     * @return Index of the material, which is valid immediately.
+     * @throw std::runtime_error If there are more materials than \p GL_MAX_ARRAY_TEXTURE_LAYERS. Other errors of \p add()
+     * are thrown by <tt>AssetLoader::processUploads()</tt>.
+     */
+    std::uint32_t addAsync(AssetLoader &asset_loader, const std::filesystem::path &diffuse_path, const std::filesystem::path &specular_path);
+
+    /**
+     * @brief Get the number of materials, including the ones not loaded yet.
+     */
+    [[nodiscard]] std::uint32_t size() const noexcept {
+        return static_cast<std::uint32_t>(diffuse_maps.getLayerCount());
+    }
+
+    /**
+     * @brief Check whether the maps of every material are uploaded.
+     */
+    [[nodiscard]] bool isLoaded() const noexcept {
+        return diffuse_maps.isComplete() && specular_maps.isComplete();
+    }
+
+    /**
+     * @brief Bind the diffuse and specular arrays, which are shared by every material. Placeholders are bound instead
+     * until \p isLoaded().
+     */
+    void bind(GLenum diffuse_unit, GLenum specular_unit) const;
+
+    /**
+     * @brief Stable sort of the object indices by their materials with counting sort, so that the objects drawn one by
+     * one change the material only \p size() times.
+     * @param indices Object indices to sort.
+     * @param material_of Function that returns the material index of an object index.
+     */
+    template <typename F> requires std::is_invocable_r_v<std::uint32_t, F, std::uint32_t>
+    void sortByMaterial(std::vector<std::uint32_t> &indices, F &&material_of) {
+        material_offsets.assign(size() + 1, 0);
+        for (std::uint32_t index : indices) {
+            ++material_offsets[material_of(index) + 1];
+        }
+        std::partial_sum(material_offsets.begin(), material_offsets.end(), material_offsets.begin());
+
+        sort_buffer.resize(indices.size());
+        for (std::uint32_t index : indices) {
+            sort_buffer[material_offsets[material_of(index)]++] = index;
+        }
+        indices.swap(sort_buffer);
+    }
+
+private:
+    // Array whose layers are the levels of texture files, grown by reallocation and reupload. Layers are reserved first,
+    // and set in any order.
+    class TextureArray {
+        GLuint texture = 0;
+        GLuint placeholder = 0; // 1x1 single layer, so every layer index is clamped to it.
+        std::vector<std::optional<TextureFile>> layers; // Memory mapped, so reupload doesn't read the files again.
+        std::size_t num_set_layers = 0;
+        std::size_t capacity = 0;
+
+        [[nodiscard]] const TextureFile::Header *findHeader() const noexcept;
+        void allocate(std::size_t new_capacity);
+        void upload(std::size_t layer) const;
+
+    public:
+        explicit TextureArray(glm::u8vec4 placeholder_color);
+        ~TextureArray();
+
+        TextureArray(const TextureArray&) = delete;
+        TextureArray &operator=(const TextureArray&) = delete;
+
+        [[nodiscard]] std::size_t getLayerCount() const noexcept {
+            return layers.size();
+        }
+
+        [[nodiscard]] bool isComplete() const noexcept {
+            return num_set_layers == layers.size();
+        }
+
+        void bind() const;
+
+        /**
+         * @brief Check whether \p file can be set to a layer.
+         * @throw std::runtime_error If the size or format differs from the set layers.
+         */
+        void validate(const TextureFile &file, const std::filesystem::path &source_path) const;
+
+        /**
+         * @brief Append an empty layer.
+         * @return Index of the layer.
+         */
+        std::size_t reserveLayer();
+        void set(std::size_t layer, TextureFile file);
+    };
+
+    TextureCache &texture_cache;
+    TextureArray diffuse_maps { { 128, 128, 128, 255 } };
+    TextureArray specular_maps { { 0, 0, 0, 255 } };
+
+    // Scratch buffers of sortByMaterial().
+    std::vector<std::uint32_t> material_offsets;
+    std::vector<std::uint32_t> sort_buffer;
+
+    /**
+     * @brief Reserve a layer in both arrays.
+     * @throw std::runtime_error If the arrays are full.
+     */
+    std::uint32_t reserveMaterial();
+};
@@ -0,0 +1,146 @@
+#include "MeshFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+    constexpr std::array vertex_pnt_attributes {
+        MeshFile::AttributeDescriptor { 0, 3, GL_FLOAT, offsetof(VertexPNT, position) },
+        MeshFile::AttributeDescriptor { 1, 3, GL_FLOAT, offsetof(VertexPNT, normal) },
+        MeshFile::AttributeDescriptor { 2, 2, GL_FLOAT, offsetof(VertexPNT, texcoords) },
+    };
+
+    constexpr std::uint64_t alignBlob(std::uint64_t offset) {
+        return (offset + MeshFile::blob_alignment - 1) / MeshFile::blob_alignment * MeshFile::blob_alignment;
+    }
+}
+
+MeshFile::MeshFile(const std::filesystem::path &path) : file { path } {
+    const std::span bytes = file.getBytes();
+    if (bytes.size() < sizeof(Header)) {
+        throw std::runtime_error { path.string() + " is not a mesh file" };
+    }
+
+    header = reinterpret_cast<const Header*>(bytes.data());
+    if (header->magic != magic) {
+        throw std::runtime_error { path.string() + " is not a mesh file" };
+    }
+    if (header->version != version) {
+        throw std::runtime_error { path.string() + " has unsupported version" };
+    }
+
+    const std::uint64_t vertex_data_end = header->vertex_data_offset + std::uint64_t { header->vertex_count } * header->vertex_stride;
+    const std::uint64_t index_data_end = header->index_data_offset + std::uint64_t { header->index_count } * header->index_size;
+    if (header->attribute_count > header->attributes.size()
+        || header->vertex_data_offset % blob_alignment != 0 || vertex_data_end > bytes.size()
+        || (header->index_size != 0 && header->index_size != 2 && header->index_size != 4)
+        || header->index_data_offset % blob_alignment != 0 || index_data_end > bytes.size()
+        || header->lod_count > max_lod_count || (header->index_size != 0 && header->lod_count == 0)) {
+        throw std::runtime_error { path.string() + " is corrupted" };
+    }
+    for (const Lod &lod : getLods()) {
+        if (std::uint64_t { lod.first_index } + lod.index_count > header->index_count) {
+            throw std::runtime_error { path.string() + " is corrupted" };
+        }
+    }
+}
+
+std::span<const VertexPNT> MeshFile::getVertices() const {
+    if (header->vertex_stride != sizeof(VertexPNT)
+        || !std::ranges::equal(std::span { header->attributes }.first(header->attribute_count), vertex_pnt_attributes)) {
+        throw std::runtime_error { "Vertex layout of the mesh file is not VertexPNT" };
+    }
+    return { reinterpret_cast<const VertexPNT*>(file.getBytes().data() + header->vertex_data_offset), header->vertex_count };
+}
+
+std::span<const std::byte> MeshFile::getIndexData() const noexcept {
+    return file.getBytes().subspan(header->index_data_offset, std::size_t { header->index_count } * header->index_size);
+}
+
+GLenum MeshFile::getIndexType() const {
+    switch (header->index_size) {
+        case 2: return GL_UNSIGNED_SHORT;
+        case 4: return GL_UNSIGNED_INT;
+        default: throw std::runtime_error { "Mesh file is not indexed" };
+    }
+}
+
+std::vector<std::uint32_t> MeshFile::getIndices(std::size_t lod) const {
+    if (header->lod_count == 0) {
+        return {}; // Non-indexed.
+    }
+
+    const Lod &range = getLods()[lod];
+    const std::span index_data = getIndexData().subspan(std::size_t { range.first_index } * header->index_size, std::size_t { range.index_count } * header->index_size);
+    std::vector<std::uint32_t> indices(range.index_count);
+    if (header->index_size == 2) {
+        for (std::size_t i = 0; i < indices.size(); ++i) {
+            std::uint16_t index16;
+            std::memcpy(&index16, index_data.data() + 2 * i, sizeof(index16));
+            indices[i] = index16;
+        }
+    }
+    else {
+        std::memcpy(indices.data(), index_data.data(), index_data.size());
+    }
+    return indices;
+}
+
+void MeshFile::write(const std::filesystem::path &path, std::span<const VertexPNT> vertices, std::span<const std::uint32_t> indices, std::span<const Lod> lods) {
+    if (lods.size() > max_lod_count) {
+        throw std::runtime_error { "Too many LODs" };
+    }
+    for (const Lod &lod : lods) {
+        if (std::size_t { lod.first_index } + lod.index_count > indices.size()) {
+            throw std::runtime_error { "LOD is out of the indices" };
+        }
+    }
+
+    Header header {};
+    header.magic = magic;
+    header.version = version;
+    header.vertex_count = static_cast<std::uint32_t>(vertices.size());
+    header.vertex_stride = sizeof(VertexPNT);
+    header.index_count = static_cast<std::uint32_t>(indices.size());
+    header.attribute_count = static_cast<std::uint32_t>(vertex_pnt_attributes.size());
+    std::ranges::copy(vertex_pnt_attributes, header.attributes.begin());
+
+    // Use 16-bit indices if possible, which halves the index bandwidth.
+    if (!indices.empty()) {
+        header.index_size = std::ranges::max(indices) <= 0xFFFF ? 2 : 4;
+
+        if (lods.empty()) {
+            header.lod_count = 1;
+            header.lods[0] = { 0, header.index_count, 0.f, 0 };
+        }
+        else {
+            header.lod_count = static_cast<std::uint32_t>(lods.size());
+            std::ranges::copy(lods, header.lods.begin());
+        }
+    }
+
+    header.vertex_data_offset = alignBlob(sizeof(Header));
+    header.index_data_offset = alignBlob(header.vertex_data_offset + vertices.size_bytes());
+
+    std::vector<std::byte> bytes(header.index_data_offset + std::size_t { header.index_count } * header.index_size);
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    std::memcpy(bytes.data() + header.vertex_data_offset, vertices.data(), vertices.size_bytes());
+    if (header.index_size == 2) {
+        auto *index_data = bytes.data() + header.index_data_offset;
+        for (std::uint32_t index : indices) {
+            const auto index16 = static_cast<std::uint16_t>(index);
+            std::memcpy(index_data, &index16, sizeof(index16));
+            index_data += sizeof(index16);
+        }
+    }
+    else {
+        std::memcpy(bytes.data() + header.index_data_offset, indices.data(), indices.size_bytes());
+    }
+
+    std::ofstream output { path, std::ios::binary };
+    if (!output.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+        throw std::runtime_error { "Failed to write " + path.string() };
+    }
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "MappedFile.hpp"
+#include "Vertex.hpp"
+
+/**
+ * Compact binary mesh file, which can be used without parsing.
+ *
+ * Layout (little endian):
+ * - \p Header, which describes the vertex layout and the location of each blob.
+ * - Vertex blob, 16-byte aligned. Vertices are stored as-is, with \p Header::vertex_stride bytes each.
+ * - Index blob (optional), 16-byte aligned. \p Header::index_size is 2 or 4 bytes, or 0 for non-indexed mesh. Index
+ *   ranges of the levels of detail are stored one after another, from the finest (LOD 0) to the coarsest, and every level
+ *   references the same vertices.
+ *
+ * Since the file is memory mapped, the vertex/index spans point to the mapped pages and can be passed to
+ * \p glBufferData directly. Use the \p mesh_converter tool to create a file.
+ */
+class MeshFile {
+public:
+    static constexpr std::array<char, 4> magic { 'M', 'P', 'M', 'F' };
+    static constexpr std::uint32_t version = 2;
+    static constexpr std::size_t blob_alignment = 16;
+    static constexpr std::size_t max_lod_count = 8;
+
+    struct AttributeDescriptor {
+        std::uint32_t location;
+        std::uint32_t num_components;
+        std::uint32_t component_type; // GLenum, e.g. GL_FLOAT.
+        std::uint32_t offset;
+
+        bool operator==(const AttributeDescriptor&) const = default;
+    };
+
+    // Level of detail, which is a range of the index blob.
+    struct Lod {
+        std::uint32_t first_index;
+        std::uint32_t index_count;
+        float error; // Distance from the LOD 0 surface in the unit of the positions, 0 for LOD 0.
+        std::uint32_t reserved;
+    };
+
+    struct Header {
+        std::array<char, 4> magic;
+        std::uint32_t version;
+        std::uint32_t vertex_count;
+        std::uint32_t vertex_stride;
+        std::uint32_t index_count; // Of every LOD.
+        std::uint32_t index_size;
+        std::uint32_t attribute_count;
+        std::uint32_t lod_count; // At least 1 for indexed mesh.
+        std::array<AttributeDescriptor, 8> attributes;
+        std::uint64_t vertex_data_offset;
+        std::uint64_t index_data_offset;
+        std::array<Lod, max_lod_count> lods;
+    };
+    static_assert(sizeof(Header) % blob_alignment == 0);
+
+    /**
+     * @brief Map and validate the mesh file.
+     * @param path Path of the file.
+     * @throw std::runtime_error If the file cannot be mapped or it is not a valid mesh file.
+     */
+    explicit MeshFile(const std::filesystem::path &path);
+
+    [[nodiscard]] const Header &getHeader() const noexcept {
+        return *header;
+    }
+
+    /**
+     * @brief Get the vertices in the mapped memory.
+     * @throw std::runtime_error If the vertex layout of the file is not the one of \p VertexPNT.
+     */
+    [[nodiscard]] std::span<const VertexPNT> getVertices() const;
+
+    /**
+     * @brief Get the raw index data of every LOD in the mapped memory. Its element size is \p getHeader().index_size.
+     */
+    [[nodiscard]] std::span<const std::byte> getIndexData() const noexcept;
+
+    /**
+     * @brief Get the levels of detail, from the finest to the coarsest. Empty for non-indexed mesh.
+     */
+    [[nodiscard]] std::span<const Lod> getLods() const noexcept {
+        return std::span { header->lods }.first(header->lod_count);
+    }
+
+    /**
+     * @brief Get the index type of \p getIndexData(), which can be passed to \p glDrawElements.
+     * @throw std::runtime_error If the mesh is not indexed.
+     */
+    [[nodiscard]] GLenum getIndexType() const;
+
+    /**
+     * @brief Get the indices of a LOD widened to 32-bit, for CPU side processing.
+     * @param lod Index of the LOD.
+     */
+    [[nodiscard]] std::vector<std::uint32_t> getIndices(std::size_t lod = 0) const;
+
+    /**
+     * @brief Write a mesh file.
+     * @param path Path of the file.
+     * @param vertices Vertices.
+     * @param indices Triangle list indices of every LOD, or empty for non-indexed mesh. Stored in 16-bit if every index
+     * fits.
+     * @param lods Ranges of \p indices, at most \p max_lod_count. If empty, \p indices is the only LOD.
+     * @throw std::runtime_error If the file cannot be written.
+     */
+    static void write(const std::filesystem::path &path, std::span<const VertexPNT> vertices, std::span<const std::uint32_t> indices = {}, std::span<const Lod> lods = {});
+
+private:
+    MappedFile file;
+    const Header *header;
+};
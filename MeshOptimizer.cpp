@@ -0,0 +1,501 @@
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <numeric>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include <glm/ext/vector_double3.hpp>
+#include <glm/ext/vector_double4.hpp>
+#include <glm/geometric.hpp>
+
+namespace {
+    // Hash and compare the vertex by its bytes, so that e.g. 0.f and -0.f are not merged (they may produce different
+    // results in the shader).
+    std::string_view getBytes(const VertexPNT &vertex) {
+        static_assert(sizeof(VertexPNT) == 2 * sizeof(glm::vec3) + sizeof(glm::vec2), "VertexPNT must not have padding");
+        return { reinterpret_cast<const char*>(&vertex), sizeof(vertex) };
+    }
+
+    constexpr std::uint32_t no_vertex = std::numeric_limits<std::uint32_t>::max();
+
+    // Border edges are weighted more than the surface, so that the silhouette of an open mesh is kept.
+    constexpr double border_weight = 10.0;
+
+    // Weighted sum of the squared distances to planes, as the symmetric matrix [A b; b^T c] applied to (p, 1).
+    struct Quadric {
+        double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+        double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+        double c = 0.0;
+        double weight = 0.0;
+
+        // Plane of dot(normal, p) + d = 0, where normal is normalized.
+        static Quadric fromPlane(const glm::dvec3 &normal, double d, double weight) {
+            return {
+                weight * normal.x * normal.x, weight * normal.x * normal.y, weight * normal.x * normal.z,
+                weight * normal.y * normal.y, weight * normal.y * normal.z, weight * normal.z * normal.z,
+                weight * normal.x * d, weight * normal.y * d, weight * normal.z * d,
+                weight * d * d,
+                weight,
+            };
+        }
+
+        Quadric &operator+=(const Quadric &rhs) noexcept {
+            a00 += rhs.a00; a01 += rhs.a01; a02 += rhs.a02; a11 += rhs.a11; a12 += rhs.a12; a22 += rhs.a22;
+            b0 += rhs.b0; b1 += rhs.b1; b2 += rhs.b2;
+            c += rhs.c;
+            weight += rhs.weight;
+            return *this;
+        }
+
+        // Weighted mean of the squared distances.
+        [[nodiscard]] double evaluate(const glm::dvec3 &p) const noexcept {
+            const double value = a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z
+                + 2.0 * (a01 * p.x * p.y + a02 * p.x * p.z + a12 * p.y * p.z)
+                + 2.0 * (b0 * p.x + b1 * p.y + b2 * p.z)
+                + c;
+            return weight > 0.0 ? std::max(value, 0.0) / weight : 0.0;
+        }
+    };
+
+    std::string_view getPositionBytes(const VertexPNT &vertex) {
+        return { reinterpret_cast<const char*>(&vertex.position), sizeof(vertex.position) };
+    }
+
+    // Compressed sparse rows: items of the key k are items[offsets[k] .. offsets[k + 1]).
+    struct Adjacency {
+        std::vector<std::uint32_t> offsets;
+        std::vector<std::uint32_t> items;
+
+        [[nodiscard]] std::span<const std::uint32_t> operator[](std::uint32_t key) const {
+            return std::span { items }.subspan(offsets[key], offsets[key + 1] - offsets[key]);
+        }
+    };
+
+    // Triangles around each vertex.
+    Adjacency buildTriangleAdjacency(std::span<const std::uint32_t> indices, std::size_t vertex_count) {
+        Adjacency adjacency { std::vector<std::uint32_t>(vertex_count + 1, 0), std::vector<std::uint32_t>(indices.size()) };
+        for (std::uint32_t index : indices) {
+            ++adjacency.offsets[index + 1];
+        }
+        std::partial_sum(adjacency.offsets.begin(), adjacency.offsets.end(), adjacency.offsets.begin());
+
+        std::vector<std::uint32_t> cursors { adjacency.offsets.begin(), adjacency.offsets.end() - 1 };
+        for (std::size_t i = 0; i < indices.size(); ++i) {
+            adjacency.items[cursors[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+        }
+        return adjacency;
+    }
+}
+
+IndexedMeshData weldVertices(std::span<const VertexPNT> vertices) {
+    IndexedMeshData mesh;
+    mesh.indices.reserve(vertices.size());
+
+    std::unordered_map<std::string_view, std::uint32_t> unique_indices;
+    unique_indices.reserve(vertices.size());
+    for (const VertexPNT &vertex : vertices) {
+        // Keys point to the input vertices, which outlive the map.
+        const auto [it, inserted] = unique_indices.try_emplace(getBytes(vertex), static_cast<std::uint32_t>(mesh.vertices.size()));
+        if (inserted) {
+            mesh.vertices.push_back(vertex);
+        }
+        mesh.indices.push_back(it->second);
+    }
+    return mesh;
+}
+
+void optimizeVertexCache(std::span<std::uint32_t> indices, std::size_t vertex_count, std::size_t cache_size) {
+    assert(indices.size() % 3 == 0);
+    const std::size_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0) {
+        return;
+    }
+
+    const Adjacency adjacency = buildTriangleAdjacency(indices, vertex_count);
+
+    // Number of not yet emitted triangles of each vertex.
+    std::vector<std::uint32_t> live_triangle_counts(vertex_count);
+    for (std::size_t vertex = 0; vertex < vertex_count; ++vertex) {
+        live_triangle_counts[vertex] = static_cast<std::uint32_t>(adjacency[static_cast<std::uint32_t>(vertex)].size());
+    }
+
+    // A vertex is in cache if (timestamp - cache_timestamps[vertex]) <= cache_size.
+    std::vector<std::size_t> cache_timestamps(vertex_count, 0);
+    std::size_t timestamp = cache_size + 1;
+
+    std::vector<bool> emitted(triangle_count, false);
+    std::vector<std::uint32_t> dead_end_stack;
+    std::vector<std::uint32_t> candidates;
+    std::vector<std::uint32_t> output;
+    output.reserve(indices.size());
+    std::size_t scan_cursor = 0;
+
+    std::uint32_t fanning_vertex = 0;
+    while (fanning_vertex != no_vertex) {
+        // Emit every remaining triangle around the fanning vertex.
+        candidates.clear();
+        for (std::uint32_t triangle : adjacency[fanning_vertex]) {
+            if (emitted[triangle]) {
+                continue;
+            }
+            for (std::uint32_t vertex : indices.subspan(3 * triangle, 3)) {
+                output.push_back(vertex);
+                dead_end_stack.push_back(vertex);
+                candidates.push_back(vertex);
+                --live_triangle_counts[vertex];
+                if (timestamp - cache_timestamps[vertex] > cache_size) {
+                    cache_timestamps[vertex] = timestamp++;
+                }
+            }
+            emitted[triangle] = true;
+        }
+
+        // Next fanning vertex: the candidate which will still be in cache after its remaining triangles are emitted, and
+        // was entered the cache earliest.
+        std::uint32_t next_vertex = no_vertex;
+        std::size_t best_priority = 0;
+        for (std::uint32_t vertex : candidates) {
+            if (live_triangle_counts[vertex] == 0) {
+                continue;
+            }
+            std::size_t priority = 1;
+            if (const std::size_t age = timestamp - cache_timestamps[vertex]; age + 2 * live_triangle_counts[vertex] <= cache_size) {
+                priority += age;
+            }
+            if (priority > best_priority) {
+                best_priority = priority;
+                next_vertex = vertex;
+            }
+        }
+
+        // Dead end: fall back to the recently used vertices, then to any vertex which has a remaining triangle.
+        while (next_vertex == no_vertex && !dead_end_stack.empty()) {
+            const std::uint32_t vertex = dead_end_stack.back();
+            dead_end_stack.pop_back();
+            if (live_triangle_counts[vertex] != 0) {
+                next_vertex = vertex;
+            }
+        }
+        for (; next_vertex == no_vertex && scan_cursor < vertex_count; ++scan_cursor) {
+            if (live_triangle_counts[scan_cursor] != 0) {
+                next_vertex = static_cast<std::uint32_t>(scan_cursor);
+            }
+        }
+
+        fanning_vertex = next_vertex;
+    }
+
+    assert(output.size() == indices.size());
+    std::ranges::copy(output, indices.begin());
+}
+
+void optimizeVertexFetch(IndexedMeshData &mesh) {
+    std::vector<std::uint32_t> remap(mesh.vertices.size(), no_vertex);
+    std::vector<VertexPNT> vertices;
+    vertices.reserve(mesh.vertices.size());
+    for (std::uint32_t &index : mesh.indices) {
+        if (remap[index] == no_vertex) {
+            remap[index] = static_cast<std::uint32_t>(vertices.size());
+            vertices.push_back(mesh.vertices[index]);
+        }
+        index = remap[index];
+    }
+    mesh.vertices = std::move(vertices);
+}
+
+float computeAcmr(std::span<const std::uint32_t> indices, std::size_t cache_size) {
+    if (indices.size() < 3) {
+        return 0.f;
+    }
+
+    std::deque<std::uint32_t> cache;
+    std::size_t num_misses = 0;
+    for (std::uint32_t index : indices) {
+        if (std::ranges::find(cache, index) != cache.end()) {
+            continue;
+        }
+
+        ++num_misses;
+        cache.push_back(index);
+        if (cache.size() > cache_size) {
+            cache.pop_front();
+        }
+    }
+    return static_cast<float>(num_misses) / static_cast<float>(indices.size() / 3);
+}
+
+std::vector<std::uint32_t> simplifyMesh(std::span<const VertexPNT> vertices, std::span<const std::uint32_t> indices, std::size_t target_index_count, float max_error, float &result_error) {
+    assert(indices.size() % 3 == 0);
+    result_error = 0.f;
+    std::vector<std::uint32_t> result { indices.begin(), indices.end() };
+
+    // Collapses work on the positions: each vertex belongs to the position group named by its first vertex.
+    std::vector<std::uint32_t> position_groups(vertices.size());
+    {
+        std::unordered_map<std::string_view, std::uint32_t> group_of_position;
+        for (std::uint32_t vertex = 0; vertex < vertices.size(); ++vertex) {
+            position_groups[vertex] = group_of_position.try_emplace(getPositionBytes(vertices[vertex]), vertex).first->second;
+        }
+    }
+    const Adjacency group_members = [&]() {
+        Adjacency members { std::vector<std::uint32_t>(vertices.size() + 1, 0), std::vector<std::uint32_t>(vertices.size()) };
+        for (std::uint32_t group : position_groups) {
+            ++members.offsets[group + 1];
+        }
+        std::partial_sum(members.offsets.begin(), members.offsets.end(), members.offsets.begin());
+        std::vector<std::uint32_t> cursors { members.offsets.begin(), members.offsets.end() - 1 };
+        for (std::uint32_t vertex = 0; vertex < vertices.size(); ++vertex) {
+            members.items[cursors[position_groups[vertex]]++] = vertex;
+        }
+        return members;
+    }();
+
+    const auto get_position = [&](std::uint32_t group) {
+        return glm::dvec3 { vertices[group].position };
+    };
+    const auto get_corner_groups = [&](std::size_t triangle) {
+        return std::array { position_groups[result[3 * triangle]], position_groups[result[3 * triangle + 1]], position_groups[result[3 * triangle + 2]] };
+    };
+
+    // Quadrics of the triangle planes weighted by area, and of the planes perpendicular to the border edges. They only
+    // order the collapses: a quadric is an area weighted mean of the squared distances, which underestimates the distance
+    // from a small triangle.
+    std::vector<Quadric> quadrics(vertices.size());
+
+    // Planes of the original triangles around each group, merged along the collapses. The largest distance of the group
+    // position from them bounds the distance of the simplified surface from the original one.
+    std::vector<glm::dvec4> planes;
+    std::vector<std::vector<std::uint32_t>> group_planes(vertices.size());
+    {
+        std::unordered_map<std::uint64_t, std::uint32_t> edge_counts; // Undirected edges of the position groups.
+        const auto edge_key = [](std::uint32_t a, std::uint32_t b) {
+            return std::uint64_t { std::min(a, b) } << 32 | std::max(a, b);
+        };
+        for (std::size_t triangle = 0; triangle < result.size() / 3; ++triangle) {
+            const std::array groups = get_corner_groups(triangle);
+            for (std::size_t i = 0; i < 3; ++i) {
+                ++edge_counts[edge_key(groups[i], groups[(i + 1) % 3])];
+            }
+        }
+
+        for (std::size_t triangle = 0; triangle < result.size() / 3; ++triangle) {
+            const std::array groups = get_corner_groups(triangle);
+            const glm::dvec3 p0 = get_position(groups[0]), p1 = get_position(groups[1]), p2 = get_position(groups[2]);
+            const glm::dvec3 cross = glm::cross(p1 - p0, p2 - p0);
+            const double double_area = glm::length(cross);
+            if (double_area == 0.0) {
+                continue;
+            }
+
+            const glm::dvec3 normal = cross / double_area;
+            const Quadric plane = Quadric::fromPlane(normal, -glm::dot(normal, p0), 0.5 * double_area);
+            const auto plane_index = static_cast<std::uint32_t>(planes.size());
+            planes.emplace_back(normal, -glm::dot(normal, p0));
+            for (std::size_t i = 0; i < 3; ++i) {
+                quadrics[groups[i]] += plane;
+                group_planes[groups[i]].push_back(plane_index);
+
+                if (edge_counts[edge_key(groups[i], groups[(i + 1) % 3])] == 1) {
+                    const glm::dvec3 edge = get_position(groups[(i + 1) % 3]) - get_position(groups[i]);
+                    const glm::dvec3 border_normal = glm::normalize(glm::cross(edge, normal));
+                    const Quadric border = Quadric::fromPlane(border_normal, -glm::dot(border_normal, get_position(groups[i])), border_weight * glm::dot(edge, edge));
+                    quadrics[groups[i]] += border;
+                    quadrics[groups[(i + 1) % 3]] += border;
+                }
+            }
+        }
+    }
+
+    struct Collapse {
+        std::uint32_t from;
+        std::uint32_t to;
+        double error; // Weighted mean of the squared distances, for ordering.
+    };
+    const double max_squared_error = static_cast<double>(max_error) * max_error;
+    std::vector<std::uint32_t> group_indices;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+    std::vector<Collapse> collapses;
+    std::vector<std::uint32_t> collapse_targets(vertices.size());
+    std::iota(collapse_targets.begin(), collapse_targets.end(), 0U);
+    std::vector<bool> locked;
+
+    // Each pass collapses the cheapest edges whose neighborhoods don't overlap, so that the costs and the flip tests of
+    // a pass are not invalidated by each other.
+    while (result.size() > target_index_count) {
+        group_indices.resize(result.size());
+        for (std::size_t i = 0; i < result.size(); ++i) {
+            group_indices[i] = position_groups[result[i]];
+        }
+        const Adjacency adjacency = buildTriangleAdjacency(group_indices, vertices.size());
+
+        edges.clear();
+        for (std::size_t i = 0; i < group_indices.size(); ++i) {
+            const std::uint32_t a = group_indices[i];
+            const std::uint32_t b = group_indices[i % 3 == 2 ? i - 2 : i + 1];
+            edges.emplace_back(std::min(a, b), std::max(a, b));
+        }
+        std::ranges::sort(edges);
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+        // Each edge collapses in the direction of the less error.
+        collapses.clear();
+        for (const auto &[a, b] : edges) {
+            Quadric sum = quadrics[a];
+            sum += quadrics[b];
+            const double error_ab = sum.evaluate(get_position(b));
+            const double error_ba = sum.evaluate(get_position(a));
+            collapses.push_back(error_ab <= error_ba ? Collapse { a, b, error_ab } : Collapse { b, a, error_ba });
+        }
+        std::ranges::sort(collapses, {}, &Collapse::error);
+
+        const auto triangle_contains = [&](std::uint32_t triangle, std::uint32_t group) {
+            return group_indices[3 * triangle] == group || group_indices[3 * triangle + 1] == group || group_indices[3 * triangle + 2] == group;
+        };
+
+        // Neighbor groups of the group, excluding itself.
+        std::vector<std::uint32_t> from_neighbors, to_neighbors;
+        const auto collect_neighbors = [&](std::uint32_t group, std::vector<std::uint32_t> &neighbors) {
+            neighbors.clear();
+            for (std::uint32_t triangle : adjacency[group]) {
+                for (std::uint32_t neighbor : std::span { group_indices }.subspan(3 * triangle, 3)) {
+                    if (neighbor != group) {
+                        neighbors.push_back(neighbor);
+                    }
+                }
+            }
+            std::ranges::sort(neighbors);
+            neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+        };
+
+        // Link condition: the ends of the edge must share only the opposite vertices of the triangles on the edge.
+        // Otherwise the collapse pinches the surface into a non-manifold fin.
+        const auto preserves_topology = [&](const Collapse &collapse) {
+            collect_neighbors(collapse.from, from_neighbors);
+            collect_neighbors(collapse.to, to_neighbors);
+            std::size_t num_shared_neighbors = 0;
+            for (std::uint32_t neighbor : from_neighbors) {
+                num_shared_neighbors += neighbor != collapse.to && std::ranges::binary_search(to_neighbors, neighbor);
+            }
+            const auto num_edge_triangles = std::ranges::count_if(adjacency[collapse.from], [&](std::uint32_t triangle) {
+                return triangle_contains(triangle, collapse.to);
+            });
+            return num_shared_neighbors == static_cast<std::size_t>(num_edge_triangles);
+        };
+
+        // Whether moving `from` onto `to` keeps the orientation of every remaining triangle around it.
+        const auto preserves_orientation = [&](const Collapse &collapse) {
+            for (std::uint32_t triangle : adjacency[collapse.from]) {
+                if (triangle_contains(triangle, collapse.to)) {
+                    continue; // Degenerates.
+                }
+
+                std::array<glm::dvec3, 3> positions;
+                for (std::size_t i = 0; i < 3; ++i) {
+                    positions[i] = get_position(group_indices[3 * triangle + i]);
+                }
+
+                const glm::dvec3 before = glm::cross(positions[1] - positions[0], positions[2] - positions[0]);
+                for (std::size_t i = 0; i < 3; ++i) {
+                    if (group_indices[3 * triangle + i] == collapse.from) {
+                        positions[i] = get_position(collapse.to);
+                    }
+                }
+                const glm::dvec3 after = glm::cross(positions[1] - positions[0], positions[2] - positions[0]);
+                // Also rejects the normal rotated by more than ~75 degrees, which mostly produces a sliver.
+                if (glm::dot(before, after) <= 0.25 * glm::length(before) * glm::length(after)) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        // Largest distance of the destination from the planes of both ends.
+        const auto get_distance_bound = [&](const Collapse &collapse) {
+            const glm::dvec3 position = get_position(collapse.to);
+            double distance = 0.0;
+            for (std::uint32_t group : { collapse.from, collapse.to }) {
+                for (std::uint32_t plane_index : group_planes[group]) {
+                    distance = std::max(distance, std::abs(glm::dot(glm::dvec3 { planes[plane_index] }, position) + planes[plane_index].w));
+                }
+            }
+            return distance;
+        };
+
+        locked.assign(vertices.size(), false);
+        std::size_t triangle_count = result.size() / 3;
+        std::size_t num_collapsed = 0;
+        for (const Collapse &collapse : collapses) {
+            // The mean is no more than the largest distance from the planes including the border ones, so the remaining
+            // collapses exceed the error or move a border.
+            if (collapse.error > max_squared_error || 3 * triangle_count <= target_index_count) {
+                break;
+            }
+            if (locked[collapse.from] || locked[collapse.to] || !preserves_topology(collapse) || !preserves_orientation(collapse)) {
+                continue;
+            }
+            const double distance = get_distance_bound(collapse);
+            if (distance > max_error) {
+                continue;
+            }
+
+            collapse_targets[collapse.from] = collapse.to;
+            quadrics[collapse.to] += quadrics[collapse.from];
+
+            std::vector<std::uint32_t> &merged_planes = group_planes[collapse.to];
+            merged_planes.insert(merged_planes.end(), group_planes[collapse.from].begin(), group_planes[collapse.from].end());
+            std::ranges::sort(merged_planes);
+            merged_planes.erase(std::unique(merged_planes.begin(), merged_planes.end()), merged_planes.end());
+            group_planes[collapse.from] = {};
+
+            for (std::uint32_t triangle : adjacency[collapse.from]) {
+                for (std::uint32_t group : std::span { group_indices }.subspan(3 * triangle, 3)) {
+                    locked[group] = true;
+                }
+                if (triangle_contains(triangle, collapse.to)) {
+                    --triangle_count;
+                }
+            }
+            result_error = std::max(result_error, static_cast<float>(distance));
+            ++num_collapsed;
+        }
+        if (num_collapsed == 0) {
+            break; // Every remaining collapse exceeds the error, or flips a triangle.
+        }
+
+        // Move the corners of the collapsed groups to the destination vertex with the closest normal (then texcoords),
+        // and remove the degenerated triangles.
+        for (std::uint32_t &vertex : result) {
+            const std::uint32_t target_group = collapse_targets[position_groups[vertex]];
+            if (target_group == position_groups[vertex]) {
+                continue;
+            }
+            vertex = std::ranges::min(group_members[target_group], {}, [&](std::uint32_t candidate) {
+                return std::pair {
+                    -glm::dot(vertices[vertex].normal, vertices[candidate].normal),
+                    glm::length(vertices[vertex].texcoords - vertices[candidate].texcoords),
+                };
+            });
+        }
+        std::iota(collapse_targets.begin(), collapse_targets.end(), 0U);
+
+        std::size_t num_kept_indices = 0;
+        for (std::size_t triangle = 0; triangle < result.size() / 3; ++triangle) {
+            const std::array groups = get_corner_groups(triangle);
+            if (groups[0] != groups[1] && groups[1] != groups[2] && groups[2] != groups[0]) {
+                std::copy_n(result.begin() + 3 * triangle, 3, result.begin() + num_kept_indices);
+                num_kept_indices += 3;
+            }
+        }
+        result.resize(num_kept_indices);
+    }
+
+    return result;
+}
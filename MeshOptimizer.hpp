@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Vertex.hpp"
+
+/**
+ * Offline mesh processing, which turns a triangle soup into an indexed mesh that is friendly to the post-transform
+ * vertex cache and the vertex fetch.
+ *
+ * @code
+ * IndexedMeshData mesh = weldVertices(soup);
+ * optimizeVertexCache(mesh.indices, mesh.vertices.size());
+ * optimizeVertexFetch(mesh);
+ *
+ * // Coarser level of detail, which shares the vertices.
+ * float lod_error;
+ * std::vector<std::uint32_t> lod_indices = simplifyMesh(mesh.vertices, mesh.indices, mesh.indices.size() / 2, max_error, lod_error);
+ * optimizeVertexCache(lod_indices, mesh.vertices.size());
+ * @endcode
+ */
+struct IndexedMeshData {
+    std::vector<VertexPNT> vertices;
+    std::vector<std::uint32_t> indices;
+};
+
+/**
+ * Size of the FIFO post-transform cache that is assumed by \p optimizeVertexCache() and \p computeAcmr(). Real hardware
+ * differs, but the ordering is not sensitive to the exact size.
+ */
+constexpr std::size_t vertex_cache_size = 16;
+
+/**
+ * @brief Merge bitwise identical vertices and build the index buffer of the triangle list.
+ * @param vertices Non-indexed triangle list.
+ * @return Unique vertices in the order of their first appearance, and the indices referencing them.
+ */
+[[nodiscard]] IndexedMeshData weldVertices(std::span<const VertexPNT> vertices);
+
+/**
+ * @brief Reorder triangles for the post-transform vertex cache locality, using Tipsify (Sander et al. 2007).
+ * @param indices Triangle list indices, reordered in-place. Winding of each triangle is preserved.
+ * @param vertex_count Number of vertices referenced by \p indices.
+ * @param cache_size Size of the FIFO cache to optimize for.
+ */
+void optimizeVertexCache(std::span<std::uint32_t> indices, std::size_t vertex_count, std::size_t cache_size = vertex_cache_size);
+
+/**
+ * @brief Reorder vertices in the order of their first reference, so that vertex fetches are mostly sequential.
+ * Unreferenced vertices are removed.
+ * @param mesh Mesh to be reordered. Its indices are remapped accordingly.
+ */
+void optimizeVertexFetch(IndexedMeshData &mesh);
+
+/**
+ * @brief Compute average cache miss ratio (vertex shader invocations per triangle) by simulating a FIFO cache.
+ * @param indices Triangle list indices.
+ * @param cache_size Size of the simulated cache.
+ * @return ACMR, which is in [0.5, 3] for a triangle list. 3 means no vertex is reused.
+ */
+[[nodiscard]] float computeAcmr(std::span<const std::uint32_t> indices, std::size_t cache_size = vertex_cache_size);
+
+/**
+ * @brief Simplify the mesh by collapsing edges in the order of their quadric error (Garland and Heckbert 1997). Each
+ * collapse moves a vertex onto the other end of the edge, so the result references the same vertices.
+ *
+ * Vertices at the same position (attribute seams, e.g. the corners of a flat shaded cube) are collapsed together, and
+ * each corner takes the vertex of the destination whose normal is the closest. Border edges are preserved by additional
+ * quadrics, and collapses that flip a triangle are rejected.
+ * @param vertices Vertices referenced by \p indices.
+ * @param indices Triangle list indices.
+ * @param target_index_count Index count to reduce to. The result may be larger if \p max_error is reached first.
+ * @param max_error Maximum distance (in the unit of the positions) of the simplified surface from the original one.
+ * @param result_error Receives the bound of the distance of the result, i.e. the largest distance of a collapsed vertex
+ * from the planes of the original triangles merged into it. It can be used to select the level of detail.
+ * @return Triangle list indices into \p vertices.
+ */
+[[nodiscard]] std::vector<std::uint32_t> simplifyMesh(std::span<const VertexPNT> vertices, std::span<const std::uint32_t> indices, std::size_t target_index_count, float max_error, float &result_error);
@@ -0,0 +1,101 @@
+#include "MeshPool.hpp"
+
+#include <cstring>
+
+namespace {
+    // Index blob of every LOD widened to 32-bit.
+    std::vector<std::uint32_t> widenIndices(const MeshFile &file) {
+        const std::span data = file.getIndexData();
+        std::vector<std::uint32_t> indices(file.getHeader().index_count);
+        if (file.getIndexType() == GL_UNSIGNED_SHORT) {
+            for (std::size_t i = 0; i < indices.size(); ++i) {
+                std::uint16_t index;
+                std::memcpy(&index, data.data() + sizeof(index) * i, sizeof(index));
+                indices[i] = index;
+            }
+        }
+        else {
+            std::memcpy(indices.data(), data.data(), data.size());
+        }
+        return indices;
+    }
+}
+
+MeshPool::MeshPool(std::span<const MeshFile> files, const OGLWrapper::Helper::VertexAttributes<VertexPNT> &vertex_attributes) {
+    // Validate every file and lay out the ranges first, so that the buffers are allocated once.
+    std::size_t vertex_count = 0;
+    std::size_t index_count = 0;
+    index_type = GL_UNSIGNED_SHORT;
+    for (const MeshFile &file : files) {
+        const std::size_t num_vertices = file.getVertices().size();
+        if (file.getIndexType() == GL_UNSIGNED_INT) {
+            index_type = GL_UNSIGNED_INT;
+        }
+
+        meshes.push_back({ static_cast<std::uint32_t>(ranges.size()), static_cast<std::uint32_t>(file.getLods().size()) });
+        for (const MeshFile::Lod &lod : file.getLods()) {
+            ranges.push_back({
+                .first_index = static_cast<std::uint32_t>(index_count + lod.first_index),
+                .index_count = lod.index_count,
+                .base_vertex = static_cast<std::int32_t>(vertex_count),
+                .error = lod.error,
+            });
+        }
+        vertex_count += num_vertices;
+        index_count += file.getHeader().index_count;
+    }
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vertex_buffer);
+    glGenBuffers(1, &index_buffer);
+
+    glBindVertexArray(vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertex_count * sizeof(VertexPNT)), nullptr, GL_STATIC_DRAW);
+    vertex_attributes.setVertexAttribArrays();
+
+    // Element array buffer binding is a part of VAO state.
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(index_count * getIndexSize()), nullptr, GL_STATIC_DRAW);
+
+    std::size_t vertex_offset = 0;
+    std::size_t index_offset = 0;
+    for (const MeshFile &file : files) {
+        const std::span vertices = file.getVertices();
+        glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(vertex_offset * sizeof(VertexPNT)), static_cast<GLsizeiptr>(vertices.size_bytes()), vertices.data());
+        vertex_offset += vertices.size();
+
+        // Mapped blob is uploaded as-is, unless it has to be widened for the other meshes.
+        const std::size_t num_indices = file.getHeader().index_count;
+        const auto index_data_offset = static_cast<GLintptr>(index_offset * getIndexSize());
+        if (file.getIndexType() == index_type) {
+            const std::span data = file.getIndexData();
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, index_data_offset, static_cast<GLsizeiptr>(data.size()), data.data());
+        }
+        else {
+            const std::vector indices = widenIndices(file);
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, index_data_offset, static_cast<GLsizeiptr>(indices.size() * sizeof(std::uint32_t)), indices.data());
+        }
+        index_offset += num_indices;
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+MeshPool::~MeshPool() {
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vertex_buffer);
+    glDeleteBuffers(1, &index_buffer);
+}
+
+void MeshPool::bind() const {
+    glBindVertexArray(vao);
+}
+
+void MeshPool::draw(std::uint32_t range) const {
+    const DrawRange &draw_range = ranges[range];
+    const void *const indices = reinterpret_cast<const void*>(getIndexSize() * draw_range.first_index);
+    glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(draw_range.index_count), index_type, indices, draw_range.base_vertex);
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <GL/gl3w.h>
+
+#include <OGLWrapper/Helper/VertexAttributes.hpp>
+
+#include "DrawCommandBuilder.hpp"
+#include "MeshFile.hpp"
+#include "Vertex.hpp"
+
+/**
+ * Vertices and indices of several meshes packed into a single vertex buffer and a single index buffer. Each level of
+ * detail of each mesh is a \p DrawRange, drawn with the base vertex of its mesh, so every mesh is drawn without switching
+ * the vertex array, and the ranges can be combined into a single multi-draw call by \p MultiDrawBatch.
+ *
+ * Indices are kept in 16-bit if every mesh stores them in 16-bit, since they are relative to the base vertex of the mesh.
+ *
+ * @code
+ * MeshPool pool { mesh_files, { 0, 1, 2 } };
+ * pool.bind();
+ * pool.draw(pool.getMesh(mesh).first_range + lod);
+ * glBindVertexArray(0);
+ * @endcode
+ */
+class MeshPool {
+public:
+    struct Mesh {
+        std::uint32_t first_range; // Index of the LOD 0 in getDrawRanges().
+        std::uint32_t lod_count;
+    };
+
+    /**
+     * @param files Indexed meshes of \p VertexPNT. Index of a file is the index of its mesh.
+     * @param vertex_attributes Attribute locations of \p VertexPNT.
+     * @throw std::runtime_error If a mesh is not indexed, or its vertex layout is not the one of \p VertexPNT.
+     */
+    MeshPool(std::span<const MeshFile> files, const OGLWrapper::Helper::VertexAttributes<VertexPNT> &vertex_attributes);
+    ~MeshPool();
+
+    MeshPool(const MeshPool&) = delete;
+    MeshPool &operator=(const MeshPool&) = delete;
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return meshes.size();
+    }
+
+    [[nodiscard]] const Mesh &getMesh(std::uint32_t mesh) const noexcept {
+        return meshes[mesh];
+    }
+
+    /**
+     * @brief Get the levels of detail of a mesh, from the finest to the coarsest.
+     */
+    [[nodiscard]] std::span<const DrawRange> getLods(std::uint32_t mesh) const noexcept {
+        return std::span { ranges }.subspan(meshes[mesh].first_range, meshes[mesh].lod_count);
+    }
+
+    /**
+     * @brief Get the draw ranges of every mesh. LODs of a mesh are consecutive.
+     */
+    [[nodiscard]] std::span<const DrawRange> getDrawRanges() const noexcept {
+        return ranges;
+    }
+
+    [[nodiscard]] GLuint getVertexBuffer() const noexcept {
+        return vertex_buffer;
+    }
+
+    [[nodiscard]] GLuint getIndexBuffer() const noexcept {
+        return index_buffer;
+    }
+
+    [[nodiscard]] GLenum getIndexType() const noexcept {
+        return index_type;
+    }
+
+    [[nodiscard]] std::size_t getIndexSize() const noexcept {
+        return index_type == GL_UNSIGNED_SHORT ? 2 : 4;
+    }
+
+    /**
+     * @brief Bind the vertex array of the pool, which is shared by every \p draw().
+     */
+    void bind() const;
+
+    /**
+     * @brief Draw a range with \p glDrawElementsBaseVertex. The vertex array must be bound by \p bind().
+     * @param range Index of the draw range.
+     */
+    void draw(std::uint32_t range) const;
+
+private:
+    GLuint vao;
+    GLuint vertex_buffer;
+    GLuint index_buffer;
+    GLenum index_type;
+    std::vector<Mesh> meshes;
+    std::vector<DrawRange> ranges;
+};
@@ -0,0 +1,104 @@
+#include "MultiDrawBatch.hpp"
+
+#include <algorithm>
+
+MultiDrawBatch::MultiDrawBatch(const MeshPool &mesh_pool,
+                               const OGLWrapper::Helper::VertexAttributes<VertexPNT> &vertex_attributes,
+                               const OGLWrapper::Helper::VertexAttributes<InstanceData> &instance_attributes)
+        : mesh_pool { mesh_pool },
+          instance_attributes { instance_attributes }
+{
+    // Vertex array of its own, since the instance attributes are a part of VAO state. Vertex and index buffers are the
+    // ones of the pool.
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, mesh_pool.getVertexBuffer());
+    vertex_attributes.setVertexAttribArrays();
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh_pool.getIndexBuffer());
+
+    // Instance attributes are bound at the first mapInstances(), when the instance buffer is created.
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+MultiDrawBatch::~MultiDrawBatch() {
+    glDeleteVertexArrays(1, &vao);
+}
+
+void MultiDrawBatch::bindInstanceAttributes(GLuint first_instance) {
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, instance_buffer.getHandle());
+    instance_attributes.setVertexAttribArrays(first_instance);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    instance_storage_version = instance_buffer.getStorageVersion();
+    bound_first_instance = first_instance;
+}
+
+std::span<InstanceData> MultiDrawBatch::mapInstances(std::size_t count) {
+    const std::span<InstanceData> mapped = instance_buffer.map(count);
+    if (instance_buffer.getStorageVersion() != instance_storage_version) {
+        bindInstanceAttributes();
+    }
+    return mapped;
+}
+
+void MultiDrawBatch::unmapInstances() {
+    instance_buffer.unmap();
+}
+
+void MultiDrawBatch::draw(std::span<const DrawElementsIndirectCommand> commands) {
+    if (commands.empty()) {
+        return;
+    }
+
+    // Instances may be in the middle of the persistently mapped ring.
+    const GLuint base_element = instance_buffer.getBaseElement();
+    const GLenum index_type = mesh_pool.getIndexType();
+    const std::size_t index_size = mesh_pool.getIndexSize();
+
+    if (isMultiDrawIndirectSupported()) {
+        const std::span<DrawElementsIndirectCommand> mapped = indirect_buffer.map(commands.size());
+        std::ranges::transform(commands, mapped.begin(), [&](DrawElementsIndirectCommand command) {
+            command.base_instance += base_element;
+            return command;
+        });
+        indirect_buffer.unmap();
+
+        // Indirect buffer binding is not a part of VAO state.
+        const void *const offset = reinterpret_cast<const void*>(sizeof(DrawElementsIndirectCommand) * indirect_buffer.getBaseElement());
+        glBindVertexArray(vao);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer.getHandle());
+        glMultiDrawElementsIndirect(GL_TRIANGLES, index_type, offset, static_cast<GLsizei>(commands.size()), 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        glBindVertexArray(0);
+        return;
+    }
+
+    const bool base_instance_supported = gl3wIsSupported(4, 2);
+    for (const DrawElementsIndirectCommand &command : commands) {
+        const GLuint base_instance = base_element + command.base_instance;
+        if (!base_instance_supported && base_instance != bound_first_instance) {
+            // OpenGL 3.3 cannot offset the instances of a draw call, so the attribute pointers are moved instead.
+            bindInstanceAttributes(base_instance);
+        }
+
+        const void *const indices = reinterpret_cast<const void*>(index_size * command.first_index);
+        const auto index_count = static_cast<GLsizei>(command.count);
+        const auto instance_count = static_cast<GLsizei>(command.instance_count);
+        glBindVertexArray(vao);
+        if (base_instance_supported) {
+            glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, index_count, index_type, indices, instance_count, command.base_vertex, base_instance);
+        }
+        else {
+            glDrawElementsInstancedBaseVertex(GL_TRIANGLES, index_count, index_type, indices, instance_count, command.base_vertex);
+        }
+    }
+    glBindVertexArray(0);
+}
+
+void MultiDrawBatch::setPersistent(bool enabled) {
+    instance_buffer.setPersistent(enabled);
+    indirect_buffer.setPersistent(enabled);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include <GL/gl3w.h>
+
+#include <OGLWrapper/Helper/VertexAttributes.hpp>
+
+#include "DrawCommandBuilder.hpp"
+#include "InstanceData.hpp"
+#include "MeshPool.hpp"
+#include "StreamingBuffer.hpp"
+
+/**
+ * Instanced draw of the meshes in a \p MeshPool, submitted as a list of \p DrawElementsIndirectCommand built by
+ * \p DrawCommandBuilder. Instance attributes are streamed into a \p StreamingBuffer every frame, and each command draws
+ * its instances starting from its base instance.
+ *
+ * Commands are submitted by the most capable path of the context:
+ * - OpenGL 4.3: written into an indirect buffer, and drawn by a single \p glMultiDrawElementsIndirect.
+ * - OpenGL 4.2: a loop of \p glDrawElementsInstancedBaseVertexBaseInstance.
+ * - OpenGL 3.3: a loop of \p glDrawElementsInstancedBaseVertex, moving the instance attribute pointers to the base
+ *   instance of each command.
+ *
+ * Every path draws the same instances with the same attributes, so the shaders don't depend on it.
+ */
+class MultiDrawBatch {
+public:
+    /**
+     * @param mesh_pool Pool whose buffers are drawn. It must outlive the batch.
+     * @param vertex_attributes Attribute locations of \p VertexPNT.
+     * @param instance_attributes Attribute locations of \p InstanceData.
+     */
+    MultiDrawBatch(const MeshPool &mesh_pool,
+                   const OGLWrapper::Helper::VertexAttributes<VertexPNT> &vertex_attributes,
+                   const OGLWrapper::Helper::VertexAttributes<InstanceData> &instance_attributes);
+    ~MultiDrawBatch();
+
+    MultiDrawBatch(const MultiDrawBatch&) = delete;
+    MultiDrawBatch &operator=(const MultiDrawBatch&) = delete;
+
+    [[nodiscard]] static bool isMultiDrawIndirectSupported() {
+        return gl3wIsSupported(4, 3);
+    }
+
+    /**
+     * @brief Get the instance buffer memory to be written in \p DrawCommandBuilder::getInstanceOrder().
+     * \p unmapInstances() must be called before \p draw().
+     * @param count Number of instances.
+     * @return Write-only memory for the instance attributes.
+     */
+    [[nodiscard]] std::span<InstanceData> mapInstances(std::size_t count);
+    void unmapInstances();
+
+    /**
+     * @brief Draw the instances written by the last \p mapInstances().
+     * @param commands Commands whose base instances are relative to the first written instance.
+     */
+    void draw(std::span<const DrawElementsIndirectCommand> commands);
+
+    /**
+     * @brief Select between the persistently mapped ring and the orphaning, for both the instance and the indirect buffer.
+     */
+    void setPersistent(bool enabled);
+
+    [[nodiscard]] const StreamingBuffer<InstanceData> &getInstanceBuffer() const noexcept {
+        return instance_buffer;
+    }
+
+private:
+    const MeshPool &mesh_pool;
+    GLuint vao;
+
+    StreamingBuffer<InstanceData> instance_buffer;
+    StreamingBuffer<DrawElementsIndirectCommand> indirect_buffer { GL_DRAW_INDIRECT_BUFFER };
+    OGLWrapper::Helper::VertexAttributes<InstanceData> instance_attributes;
+    std::uint64_t instance_storage_version = 0; // Storage version of instance_buffer which the VAO refers.
+    GLuint bound_first_instance = 0; // Instance at which the attribute pointers of the VAO start.
+
+    void bindInstanceAttributes(GLuint first_instance = 0);
+};
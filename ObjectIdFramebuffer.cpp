@@ -0,0 +1,94 @@
+#include "ObjectIdFramebuffer.hpp"
+
+#include <stdexcept>
+
+void ObjectIdFramebuffer::allocateStorages() {
+    glBindRenderbuffer(GL_RENDERBUFFER, color_renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, size.x, size.y);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_stencil_renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, size.x, size.y);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glBindTexture(GL_TEXTURE_2D, object_id_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, size.x, size.y, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+ObjectIdFramebuffer::ObjectIdFramebuffer(glm::ivec2 size) : size { size } {
+    glGenFramebuffers(1, &framebuffer);
+    glGenRenderbuffers(1, &color_renderbuffer);
+    glGenRenderbuffers(1, &depth_stencil_renderbuffer);
+    glGenTextures(1, &object_id_texture);
+
+    // Integer textures are incomplete with linear filtering.
+    glBindTexture(GL_TEXTURE_2D, object_id_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    allocateStorages();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_renderbuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, object_id_texture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth_stencil_renderbuffer);
+
+    constexpr GLenum draw_buffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, draw_buffers);
+
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        throw std::runtime_error { "Object ID framebuffer is incomplete" };
+    }
+}
+
+ObjectIdFramebuffer::~ObjectIdFramebuffer() {
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &color_renderbuffer);
+    glDeleteRenderbuffers(1, &depth_stencil_renderbuffer);
+    glDeleteTextures(1, &object_id_texture);
+}
+
+void ObjectIdFramebuffer::resize(glm::ivec2 new_size) {
+    if (new_size != size) {
+        size = new_size;
+        allocateStorages();
+    }
+}
+
+void ObjectIdFramebuffer::bindAndClear(std::uint32_t clear_object_id, GLint clear_stencil) const {
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+    constexpr GLfloat clear_color[] = { 0.f, 0.f, 0.f, 0.f };
+    glClearBufferfv(GL_COLOR, 0, clear_color);
+    const GLuint clear_ids[] = { clear_object_id, 0, 0, 0 };
+    glClearBufferuiv(GL_COLOR, 1, clear_ids);
+    glClearBufferfi(GL_DEPTH_STENCIL, 0, 1.f, clear_stencil);
+}
+
+void ObjectIdFramebuffer::bindObjectIdForRead() const {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glReadBuffer(GL_COLOR_ATTACHMENT1);
+}
+
+std::uint32_t ObjectIdFramebuffer::readObjectId(glm::ivec2 position) const {
+    std::uint32_t object_id;
+    bindObjectIdForRead();
+    glReadPixels(position.x, position.y, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_INT, &object_id);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    return object_id;
+}
+
+void ObjectIdFramebuffer::blitColor(GLuint target_framebuffer) const {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target_framebuffer);
+    glBlitFramebuffer(0, 0, size.x, size.y, 0, 0, size.x, size.y, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, target_framebuffer);
+}
+
+void ObjectIdFramebuffer::bindObjectIdTexture(GLenum unit) const {
+    glActiveTexture(unit);
+    glBindTexture(GL_TEXTURE_2D, object_id_texture);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+
+#include <GL/gl3w.h>
+
+#include <glm/ext/vector_int2.hpp>
+
+/**
+ * Offscreen framebuffer with a color attachment (location 0), a 32-bit unsigned integer object ID attachment
+ * (location 1) and a depth-stencil attachment. Since every fragment stores which object it belongs to, picking is not
+ * limited by the 8-bit stencil buffer.
+ *
+ * After the scene is drawn, color attachment should be blitted to the default (or target) framebuffer by \p blitColor().
+ */
+class ObjectIdFramebuffer {
+    GLuint framebuffer;
+    GLuint color_renderbuffer;
+    GLuint depth_stencil_renderbuffer;
+    GLuint object_id_texture;
+    glm::ivec2 size;
+
+    void allocateStorages();
+
+public:
+    explicit ObjectIdFramebuffer(glm::ivec2 size);
+    ~ObjectIdFramebuffer();
+
+    ObjectIdFramebuffer(const ObjectIdFramebuffer&) = delete;
+    ObjectIdFramebuffer &operator=(const ObjectIdFramebuffer&) = delete;
+
+    [[nodiscard]] glm::ivec2 getSize() const noexcept {
+        return size;
+    }
+
+    void resize(glm::ivec2 new_size);
+
+    /**
+     * @brief Bind as the draw framebuffer, and clear all attachments.
+     * @param clear_object_id Object ID for the pixels where nothing is drawn.
+     * @param clear_stencil Stencil value for the pixels where nothing is drawn.
+     */
+    void bindAndClear(std::uint32_t clear_object_id, GLint clear_stencil) const;
+
+    /**
+     * @brief Bind as the read framebuffer with the object ID attachment as read buffer, so that \p glReadPixels with
+     * \p GL_RED_INTEGER and \p GL_UNSIGNED_INT reads the object IDs. Caller must bind the default framebuffer after
+     * reading.
+     */
+    void bindObjectIdForRead() const;
+
+    /**
+     * @brief Read the object ID at \p position synchronously.
+     * @param position Position in framebuffer (bottom-left origined) coordinates.
+     * @return Object ID at the position.
+     */
+    [[nodiscard]] std::uint32_t readObjectId(glm::ivec2 position) const;
+
+    /**
+     * @brief Copy the color attachment to \p target_framebuffer, and bind it.
+     * @param target_framebuffer Destination framebuffer, which has the same size. 0 means the default framebuffer.
+     */
+    void blitColor(GLuint target_framebuffer = 0) const;
+
+    void bindObjectIdTexture(GLenum unit) const;
+};
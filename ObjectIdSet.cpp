@@ -0,0 +1,51 @@
+#include "ObjectIdSet.hpp"
+
+#include <bit>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OBJECT_ID_SET_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+ObjectIdSet::ObjectIdSet(std::uint32_t id_count) : id_count { id_count }, words((id_count + 63) / 64, 0) {
+
+}
+
+void ObjectIdSet::insert(std::span<const std::uint32_t> ids) {
+    if (ids.empty()) {
+        return;
+    }
+
+    insert(ids[0]);
+    std::size_t i = 1;
+
+#ifdef OBJECT_ID_SET_USE_SSE
+    // Compare four IDs with their predecessors. Since the predecessor is already inserted, only the IDs that differ from
+    // it have to be inserted, which is none for the most of the region.
+    for (; i + 4 <= ids.size(); i += 4) {
+        const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&ids[i]));
+        const __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&ids[i - 1]));
+        const int same_mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(current, previous)));
+        for (int changed_mask = ~same_mask & 0xF; changed_mask != 0; changed_mask &= changed_mask - 1) {
+            insert(ids[i + std::countr_zero(static_cast<unsigned>(changed_mask))]);
+        }
+    }
+#endif
+
+    // Remainder of SIMD loop, or whole IDs if SSE2 is not available.
+    for (; i < ids.size(); ++i) {
+        if (ids[i] != ids[i - 1]) {
+            insert(ids[i]);
+        }
+    }
+}
+
+std::vector<std::uint32_t> ObjectIdSet::toVector() const {
+    std::vector<std::uint32_t> result;
+    for (std::size_t word_index = 0; word_index < words.size(); ++word_index) {
+        for (std::uint64_t word = words[word_index]; word != 0; word &= word - 1) {
+            result.push_back(static_cast<std::uint32_t>(64 * word_index + std::countr_zero(word)));
+        }
+    }
+    return result;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * Set of object IDs stored as a bitset, for reducing a region of the object ID buffer (which has the same ID for most
+ * adjacent pixels) into the unique IDs in it.
+ *
+ * @code
+ * ObjectIdSet set { num_objects };
+ * set.insert(object_ids); // Pixels of the region.
+ * std::vector<std::uint32_t> selected = set.toVector();
+ * @endcode
+ */
+class ObjectIdSet {
+public:
+    /**
+     * @param id_count IDs in <tt>[0, id_count)</tt> are collected, others (e.g. background) are ignored.
+     */
+    explicit ObjectIdSet(std::uint32_t id_count);
+
+    /**
+     * @brief Insert the IDs. Runs of the same ID are skipped four pixels at once with SSE2.
+     * @param ids IDs to insert.
+     */
+    void insert(std::span<const std::uint32_t> ids);
+
+    [[nodiscard]] bool contains(std::uint32_t id) const noexcept {
+        return id < id_count && (words[id / 64] >> (id % 64) & 1);
+    }
+
+    /**
+     * @brief Get the IDs in the set in ascending order.
+     */
+    [[nodiscard]] std::vector<std::uint32_t> toVector() const;
+
+private:
+    std::uint32_t id_count;
+    std::vector<std::uint64_t> words;
+
+    void insert(std::uint32_t id) noexcept {
+        if (id < id_count) {
+            words[id / 64] |= std::uint64_t { 1 } << (id % 64);
+        }
+    }
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include <glm/ext/vector_int2.hpp>
+
+/**
+ * Deduplicates picking queries whose result cannot differ from the last one.
+ *
+ * An object under a pixel only changes if the cursor moves to another pixel, or the camera or the objects change. Each
+ * query is identified by the pixel and the versions of the camera and the scene content it is picked from, and a query
+ * same as the last one is a hit, which doesn't have to be picked (or read back) again. The result itself is not stored,
+ * since the hovered index of the last pick is already the result, even if it is still in flight by an asynchronous
+ * readback.
+ *
+ * @code
+ * if (!picking_cache.deduplicate({ cursor_position, camera_version, content_version })) {
+ *     hovered_index = pick(cursor_position);
+ * }
+ * @endcode
+ */
+class PickingCache {
+public:
+    struct Query {
+        glm::ivec2 position;             // In framebuffer coordinates.
+        std::uint64_t camera_version;    // Increased whenever view or projection is changed.
+        std::uint64_t content_version;   // Increased whenever the objects (or what of them is drawn) are changed.
+
+        bool operator==(const Query&) const = default;
+    };
+
+    struct Statistics {
+        std::uint64_t num_hits = 0;   // Queries skipped since they were same as the last one.
+        std::uint64_t num_misses = 0; // Queries that had to be picked.
+    };
+
+    /**
+     * @brief Check whether \p query is same as the last one. If not, it becomes the last one, and the caller must pick.
+     * @return \p true if the query is a hit, \p false otherwise.
+     */
+    bool deduplicate(const Query &query) noexcept {
+        if (last_query == query) {
+            ++statistics.num_hits;
+            return true;
+        }
+        last_query = query;
+        ++statistics.num_misses;
+        return false;
+    }
+
+    /**
+     * @brief Forget the last query, e.g. when the hovered index is reset or the pending readbacks are discarded, so that
+     * the next query is always picked.
+     */
+    void invalidate() noexcept {
+        last_query.reset();
+    }
+
+    [[nodiscard]] const Statistics &getStatistics() const noexcept {
+        return statistics;
+    }
+
+private:
+    std::optional<Query> last_query;
+    Statistics statistics;
+};
@@ -0,0 +1,60 @@
+#include "PixelReadback.hpp"
+
+PixelReadback::PixelReadback() {
+    for (Slot &slot : slots) {
+        glGenBuffers(1, &slot.buffer);
+    }
+}
+
+PixelReadback::~PixelReadback() {
+    for (Slot &slot : slots) {
+        release(slot);
+        glDeleteBuffers(1, &slot.buffer);
+    }
+}
+
+void PixelReadback::request(std::uint64_t frame_index, glm::ivec2 offset, glm::ivec2 extent, GLenum format, GLenum type, std::size_t pixel_size) {
+    Slot &slot = slots[next_slot];
+    next_slot = (next_slot + 1) % ring_size;
+
+    if (slot.fence) {
+        // GPU is more than `latency` frames behind: the oldest readback is never consumed. Wait for it to not overwrite
+        // the buffer that is still being written.
+        glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        release(slot);
+        ++statistics.num_stalls;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    slot.size = static_cast<std::size_t>(extent.x) * static_cast<std::size_t>(extent.y) * pixel_size;
+    if (slot.size > slot.capacity) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(slot.size), nullptr, GL_STREAM_READ);
+        slot.capacity = slot.size;
+    }
+
+    // With a pixel pack buffer bound, the last parameter is an offset into the buffer and the call returns immediately.
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(offset.x, offset.y, extent.x, extent.y, format, type, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.request = { frame_index, std::chrono::steady_clock::now(), offset, extent };
+}
+
+void PixelReadback::clear() {
+    for (Slot &slot : slots) {
+        release(slot);
+    }
+}
+
+bool PixelReadback::isSignaled(const Slot &slot) {
+    const GLenum result = glClientWaitSync(slot.fence, 0, 0);
+    return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+}
+
+void PixelReadback::release(Slot &slot) {
+    if (slot.fence) {
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+    }
+}
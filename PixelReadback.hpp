@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <GL/gl3w.h>
+
+#include <glm/ext/vector_int2.hpp>
+
+/**
+ * Asynchronous framebuffer readback through a ring of pixel buffer objects.
+ *
+ * \p glReadPixels into client memory blocks until every previous draw call finished. Instead, \p request() issues the
+ * read into a pixel pack buffer with a fence, and \p consume() maps the buffer only after \p latency frames passed and
+ * the fence is signaled, so CPU never waits for the GPU in the common case.
+ *
+ * @code
+ * // Once per frame, after the scene is drawn.
+ * readback.consume(frame_index, [&](std::span<const std::byte> data, const PixelReadback::Request &request) {
+ *     // data is the pixels read at frame request.frame_index.
+ * });
+ * readback.request(frame_index, cursor_position, { 1, 1 }, GL_STENCIL_INDEX, GL_UNSIGNED_BYTE, 1);
+ * @endcode
+ */
+class PixelReadback {
+public:
+    static constexpr std::size_t ring_size = 3;
+    static constexpr std::uint64_t latency = ring_size - 1;
+
+    struct Request {
+        std::uint64_t frame_index;
+        std::chrono::steady_clock::time_point issued_time;
+        glm::ivec2 offset;
+        glm::ivec2 extent;
+    };
+
+    struct Statistics {
+        float latency_ms = 0.f;           // Time between the request and consume of the last readback.
+        std::uint64_t latency_frames = 0; // Frames between the request and consume of the last readback.
+        std::uint64_t num_stalls = 0;     // How many times request() had to wait for an unfinished readback.
+        std::uint64_t num_consumed = 0;   // How many readbacks were consumed, i.e. how many times latency_* were updated.
+    };
+
+    PixelReadback();
+    ~PixelReadback();
+
+    PixelReadback(const PixelReadback&) = delete;
+    PixelReadback &operator=(const PixelReadback&) = delete;
+
+    /**
+     * @brief Read the pixels of the current read framebuffer asynchronously.
+     * @param frame_index Index of the current frame. It must be increased by one each frame.
+     * @param offset Bottom-left corner of the region, in framebuffer coordinates.
+     * @param extent Size of the region.
+     * @param format, type Passed to \p glReadPixels.
+     * @param pixel_size Size of a pixel in bytes, for given \p format and \p type.
+     * @note If all buffers in the ring are pending, the oldest one is waited and discarded.
+     */
+    void request(std::uint64_t frame_index, glm::ivec2 offset, glm::ivec2 extent, GLenum format, GLenum type, std::size_t pixel_size);
+
+    /**
+     * @brief Invoke \p f with the most recent finished readback which was requested at least \p latency frames ago, and
+     * release every older one.
+     * @param frame_index Index of the current frame.
+     * @param f Invoked as <tt>f(std::span<const std::byte> data, const Request &request)</tt>. Not invoked if there is no
+     * finished readback.
+     * @return \p true if \p f is invoked, \p false otherwise.
+     */
+    template <typename F>
+    bool consume(std::uint64_t frame_index, F &&f) {
+        Slot *latest = nullptr;
+        for (std::size_t i = 0; i < ring_size; ++i) {
+            Slot &slot = slots[(next_slot + i) % ring_size]; // From the oldest.
+            if (!slot.fence) {
+                continue; // Already consumed or never requested.
+            }
+            if (slot.request.frame_index + latency > frame_index || !isSignaled(slot)) {
+                break;
+            }
+            if (latest) {
+                release(*latest); // Superseded by the newer one.
+            }
+            latest = &slot;
+        }
+        if (!latest) {
+            return false;
+        }
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, latest->buffer);
+        const auto *data = static_cast<const std::byte*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(latest->size), GL_MAP_READ_BIT));
+        f(std::span { data, latest->size }, latest->request);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        statistics.latency_ms = std::chrono::duration<float, std::milli> { std::chrono::steady_clock::now() - latest->request.issued_time }.count();
+        statistics.latency_frames = frame_index - latest->request.frame_index;
+        ++statistics.num_consumed;
+        release(*latest);
+        return true;
+    }
+
+    /**
+     * @brief Discard every pending readback.
+     */
+    void clear();
+
+    [[nodiscard]] const Statistics &getStatistics() const noexcept {
+        return statistics;
+    }
+
+private:
+    struct Slot {
+        GLuint buffer;
+        std::size_t capacity = 0;
+        std::size_t size = 0;
+        GLsync fence = nullptr;
+        Request request;
+    };
+
+    std::array<Slot, ring_size> slots;
+    std::size_t next_slot = 0;
+    Statistics statistics;
+
+    static bool isSignaled(const Slot &slot);
+    static void release(Slot &slot);
+};
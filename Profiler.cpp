@@ -0,0 +1,160 @@
+#include "Profiler.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+
+Profiler::Scope::Scope(Profiler *profiler, const char *name) : profiler { profiler } {
+    if (!profiler) {
+        return;
+    }
+
+    Frame &frame = profiler->frames[profiler->current_frame];
+    if (frame.num_used_queries + 2 > frame.queries.size()) {
+        const std::size_t num_queries = frame.queries.size();
+        frame.queries.resize(num_queries + 2);
+        glGenQueries(2, frame.queries.data() + num_queries);
+    }
+
+    event_index = frame.events.size();
+    frame.events.push_back({ profiler->getZoneIndex(name), Clock::now(), {}, frame.num_used_queries });
+    glQueryCounter(frame.queries[frame.num_used_queries], GL_TIMESTAMP);
+    frame.num_used_queries += 2;
+    ++profiler->current_depth;
+}
+
+Profiler::Scope::~Scope() {
+    if (!profiler) {
+        return;
+    }
+
+    --profiler->current_depth;
+    Frame &frame = profiler->frames[profiler->current_frame];
+    Event &event = frame.events[event_index];
+    glQueryCounter(frame.queries[event.query_index + 1], GL_TIMESTAMP);
+    event.cpu_end = Clock::now();
+}
+
+Profiler::Profiler() {
+    beginFrame();
+}
+
+Profiler::~Profiler() {
+    for (Frame &frame : frames) {
+        glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+    }
+}
+
+void Profiler::beginFrame() {
+    // Pending frames are resolved from the oldest one, so that the history is in order, while their results are available.
+    for (std::size_t i = 1; i <= num_buffers; ++i) {
+        Frame &frame = frames[(current_frame + i) % num_buffers];
+        if (!frame.pending) {
+            continue;
+        }
+        if (!isGpuAvailable(frame)) {
+            break;
+        }
+        resolve(frame, true);
+    }
+
+    current_frame = (current_frame + 1) % num_buffers;
+    Frame &frame = frames[current_frame];
+    if (frame.pending) {
+        // GPU is num_buffers frames behind. Its queries are reused without waiting, so the GPU sample is dropped.
+        resolve(frame, false);
+    }
+
+    frame.pending = true;
+    frame.events.clear();
+    frame.num_used_queries = 0;
+    frame.cpu_reference = Clock::now();
+    glGetInteger64v(GL_TIMESTAMP, &frame.gpu_reference);
+}
+
+void Profiler::writeChromeTrace(const std::filesystem::path &path) const {
+    std::ofstream output { path };
+    output << "{\"traceEvents\":[\n"
+           << R"({"name":"thread_name","ph":"M","pid":1,"tid":1,"args":{"name":"CPU"}},)" << '\n'
+           << R"({"name":"thread_name","ph":"M","pid":1,"tid":2,"args":{"name":"GPU"}})";
+    for (const std::vector<TraceEvent> &trace_frame : trace_frames) {
+        for (const TraceEvent &event : trace_frame) {
+            output << ",\n{\"name\":\"" << zones[event.zone_index].name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << (event.gpu ? 2 : 1)
+                   << ",\"ts\":" << event.begin_us << ",\"dur\":" << event.duration_us << '}';
+        }
+    }
+    output << "\n]}\n";
+
+    if (!output) {
+        throw std::runtime_error { "Failed to write " + path.string() };
+    }
+}
+
+std::size_t Profiler::getZoneIndex(const char *name) {
+    for (std::size_t i = 0; i < zones.size(); ++i) {
+        if (std::strcmp(zones[i].name, name) == 0) {
+            return i;
+        }
+    }
+    zones.push_back({ .name = name, .depth = current_depth });
+    return zones.size() - 1;
+}
+
+bool Profiler::isGpuAvailable(const Frame &frame) {
+    if (frame.events.empty()) {
+        return true;
+    }
+
+    // Timestamp queries finish in order, therefore if the last one is available, all of them are.
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(frame.queries[frame.num_used_queries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    return available == GL_TRUE;
+}
+
+void Profiler::resolve(Frame &frame, bool gpu_available) {
+    frame.pending = false;
+    if (frame.events.empty()) {
+        return;
+    }
+
+    std::vector<float> cpu_ms(zones.size(), 0.f), gpu_ms(zones.size(), 0.f);
+    std::vector<TraceEvent> &trace_frame = trace_frames.emplace_back();
+    const auto to_us = [&](Clock::time_point time) {
+        return std::chrono::duration<double, std::micro> { time - start_time }.count();
+    };
+    for (const Event &event : frame.events) {
+        const std::chrono::duration<double, std::micro> cpu_duration = event.cpu_end - event.cpu_begin;
+        cpu_ms[event.zone_index] += static_cast<float>(cpu_duration.count() / 1e3);
+        trace_frame.push_back({ event.zone_index, false, to_us(event.cpu_begin), cpu_duration.count() });
+
+        if (gpu_available) {
+            GLuint64 gpu_begin, gpu_end;
+            glGetQueryObjectui64v(frame.queries[event.query_index], GL_QUERY_RESULT, &gpu_begin);
+            glGetQueryObjectui64v(frame.queries[event.query_index + 1], GL_QUERY_RESULT, &gpu_end);
+            gpu_ms[event.zone_index] += static_cast<float>(static_cast<double>(gpu_end - gpu_begin) / 1e6);
+
+            // GPU timestamps are in nanoseconds.
+            const double begin_us = to_us(frame.cpu_reference) + static_cast<double>(static_cast<GLint64>(gpu_begin) - frame.gpu_reference) / 1e3;
+            trace_frame.push_back({ event.zone_index, true, begin_us, static_cast<double>(gpu_end - gpu_begin) / 1e3 });
+        }
+    }
+
+    if (trace_frames.size() > num_trace_frames) {
+        trace_frames.pop_front();
+    }
+
+    for (std::size_t i = 0; i < zones.size(); ++i) {
+        Zone &zone = zones[i];
+        zone.cpu_ms[history_offset] = cpu_ms[i];
+        zone.cpu_ms_average = std::reduce(zone.cpu_ms.cbegin(), zone.cpu_ms.cend()) / num_history;
+        if (gpu_available) {
+            zone.gpu_ms[gpu_history_offset] = gpu_ms[i];
+            zone.gpu_ms_average = std::reduce(zone.gpu_ms.cbegin(), zone.gpu_ms.cend()) / num_history;
+        }
+    }
+    history_offset = (history_offset + 1) % num_history;
+    if (gpu_available) {
+        gpu_history_offset = (gpu_history_offset + 1) % num_history;
+    }
+}
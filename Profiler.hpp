@@ -0,0 +1,139 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include <GL/gl3w.h>
+
+/**
+ * CPU and GPU frame phase profiler.
+ *
+ * Each zone measures the CPU time by \p std::chrono::steady_clock and the GPU time by a pair of \p GL_TIMESTAMP
+ * queries. GPU results are read once they are available, up to \p num_buffers - 1 frames later, so profiling never
+ * stalls the pipeline. Frames are kept pending until then; if the GPU is further behind, the frame is recorded without
+ * its GPU sample, rather than a zero one.
+ *
+ * @code
+ * profiler.beginFrame();
+ * {
+ *     const Profiler::Scope zone { &profiler, "draw" }; // Zones can be nested.
+ *     // ...
+ * }
+ * @endcode
+ */
+class Profiler {
+public:
+    static constexpr std::size_t num_buffers = 4;
+    static constexpr std::size_t num_history = 1 << 8;
+    static constexpr std::size_t num_trace_frames = 1 << 8;
+
+    struct Zone {
+        const char *name;
+        std::size_t depth; // Nesting depth of the zone when it was first opened.
+        std::array<float, num_history> cpu_ms {};
+        std::array<float, num_history> gpu_ms {};
+        float cpu_ms_average = 0.f;
+        float gpu_ms_average = 0.f;
+    };
+
+    /**
+     * RAII profiling zone. Does nothing if the profiler is \p nullptr.
+     */
+    class Scope {
+        Profiler *profiler;
+        std::size_t event_index;
+
+    public:
+        Scope(Profiler *profiler, const char *name);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope &operator=(const Scope&) = delete;
+    };
+
+    Profiler();
+    ~Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler &operator=(const Profiler&) = delete;
+
+    /**
+     * @brief Resolve the finished GPU queries of previous frames, and start recording a new frame.
+     */
+    void beginFrame();
+
+    /**
+     * @brief Zones in the order of their first appearance.
+     */
+    [[nodiscard]] std::span<const Zone> getZones() const noexcept {
+        return zones;
+    }
+
+    /**
+     * @brief Index of the next history entry to be written, i.e. the oldest entry, of \p Zone::cpu_ms.
+     */
+    [[nodiscard]] std::size_t getHistoryOffset() const noexcept {
+        return history_offset;
+    }
+
+    /**
+     * @brief Index of the next history entry to be written of \p Zone::gpu_ms. Differs from \p getHistoryOffset() if some
+     * GPU samples are dropped.
+     */
+    [[nodiscard]] std::size_t getGpuHistoryOffset() const noexcept {
+        return gpu_history_offset;
+    }
+
+    /**
+     * @brief Write resolved zones of the last \p num_trace_frames frames as Chrome trace event format (which can be opened
+     * in chrome://tracing or Perfetto). CPU and GPU zones are written as separate threads.
+     * @param path Path of the JSON file.
+     * @throw std::runtime_error If the file cannot be written.
+     */
+    void writeChromeTrace(const std::filesystem::path &path) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Event {
+        std::size_t zone_index;
+        Clock::time_point cpu_begin, cpu_end;
+        std::size_t query_index; // queries[query_index] and queries[query_index + 1] are the begin/end timestamps.
+    };
+
+    struct Frame {
+        std::vector<Event> events;
+        std::vector<GLuint> queries;
+        std::size_t num_used_queries = 0;
+        bool pending = false; // Recorded, but not resolved yet.
+        // CPU time and GPU timestamp at the beginning of the frame, to place GPU zones on the CPU timeline.
+        Clock::time_point cpu_reference;
+        GLint64 gpu_reference;
+    };
+
+    // Resolved zone, in microseconds since the profiler was created.
+    struct TraceEvent {
+        std::size_t zone_index;
+        bool gpu;
+        double begin_us, duration_us;
+    };
+
+    std::vector<Zone> zones;
+    std::array<Frame, num_buffers> frames;
+    std::size_t current_frame = 0;
+    std::size_t current_depth = 0;
+    std::size_t history_offset = 0;
+    std::size_t gpu_history_offset = 0;
+    Clock::time_point start_time = Clock::now();
+    std::deque<std::vector<TraceEvent>> trace_frames;
+
+    std::size_t getZoneIndex(const char *name);
+    [[nodiscard]] static bool isGpuAvailable(const Frame &frame);
+    void resolve(Frame &frame, bool gpu_available);
+};
@@ -0,0 +1,827 @@
+#include "Scene.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <numeric>
+#include <string>
+#include <string_view>
+
+#include <OGLWrapper/Helper/Camera.hpp>
+
+#include <glm/geometric.hpp>
+
+#include "InputLog.hpp"
+
+namespace {
+    template <typename F>
+    float measureMilliseconds(F &&f) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        return std::chrono::duration<float, std::milli> { std::chrono::steady_clock::now() - start }.count();
+    }
+
+    // Meshes in assets/models, converted by mesh_converter. Index in this list is the mesh index.
+    constexpr std::string_view mesh_names[] = { "cube", "pyramid", "octahedron" };
+
+    std::vector<MeshFile> loadMeshFiles() {
+        std::vector<MeshFile> files;
+        files.reserve(std::size(mesh_names));
+        for (std::string_view name : mesh_names) {
+            files.emplace_back(std::filesystem::path { "assets/models" } / (std::string { name } + ".mesh"));
+        }
+        return files;
+    }
+}
+
+Scene::Scene(glm::ivec2 framebuffer_size, GLuint target_framebuffer)
+        : mesh_files { loadMeshFiles() },
+          mesh_pool { mesh_files, { 0, 1, 2 } },
+          scene_batch { mesh_pool, { 0, 1, 2 }, { 3, 7, 10, 11 } },
+          selection_outline_batch { mesh_pool, { 0, 1, 2 }, { 3, 7, 10, 11 } },
+          target_framebuffer { target_framebuffer },
+          framebuffer_size { framebuffer_size }
+{
+    // "Wooden crate", and "steel frame placeholder", which has no diffuse texture of its own yet and uses the specular
+    // map of the crate (its steel frame on black) as the diffuse map. Maps of both are 500x500 and opaque, so they are
+    // packed into the same arrays.
+    material_registry.addAsync(asset_loader, "assets/textures/container2.png", "assets/textures/container2_specular.png");
+    material_registry.addAsync(asset_loader, "assets/textures/container2_specular.png", "assets/textures/container2_specular.png");
+
+    // Local bounds of the meshes, which are transformed into the world space bounds of the instances. Culling uses a
+    // single radius, large enough for every mesh.
+    mesh_radius = 0.f;
+    for (const MeshFile &file : mesh_files) {
+        MeshShape &shape = mesh_shapes.emplace_back(MeshShape { file.getVertices(), file.getIndices(), {} });
+        for (const VertexPNT &vertex : shape.vertices) {
+            shape.bounds.expand(vertex.position);
+            mesh_radius = std::max(mesh_radius, length(vertex.position));
+        }
+    }
+
+    initModels(scene_layout);
+
+    for (const OGLWrapper::Program *program : { &primary_program, &instanced_program, &outliner_program, &object_id_outliner_program, &selection_outliner_program }) {
+        UniformBuffer<VpMatrix>::bindBlock(*program);
+        UniformBuffer<DirectionalLight>::bindBlock(*program);
+    }
+
+    // Set texture.
+    primary_program.pendUniforms([&]() {
+        primary_uniforms.diffuse_maps.set(0);
+        primary_uniforms.specular_maps.set(1);
+    });
+    instanced_program.pendUniforms([&]() {
+        instanced_uniforms.diffuse_maps.set(0);
+        instanced_uniforms.specular_maps.set(1);
+    });
+    object_id_outliner_program.pendUniforms([&]() {
+        object_id_outliner_uniforms.object_id_map.set(2);
+    });
+    selection_outliner_program.pendUniforms([&]() {
+        selection_outliner_uniforms.object_id_map.set(2);
+    });
+
+    // Enable OpenGL features.
+    glEnable(GL_DEPTH_TEST);
+
+    glEnable(GL_CULL_FACE);
+
+    // At first, stencil buffer will filled with `no_hover_stencil`.
+    // At draw call, stencil buffer will be filled with `idx` if the fragment is drawn and depth test is passed.
+    // After that, we can retrieve the index of the mesh under the cursor by reading stencil buffer.
+    glEnable(GL_STENCIL_TEST);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+    glStencilMask(0xFF);
+    glClearStencil(no_hover_stencil);
+}
+
+void Scene::resize(glm::ivec2 framebuffer_size) {
+    if (recorder) {
+        recorder->record(InputLog::Resize { framebuffer_size });
+    }
+    this->framebuffer_size = framebuffer_size;
+    object_id_framebuffer.resize(framebuffer_size);
+    ++content_version;
+}
+
+void Scene::setCamera(const glm::mat4 &view, const glm::mat4 &projection) {
+    if (recorder) {
+        recorder->record(InputLog::Camera { view, projection });
+    }
+    this->view = view;
+    this->projection = projection;
+    ++camera_version;
+
+    const glm::mat4 inv_view = inverse(view);
+    view_position = OGLWrapper::Helper::Camera::getPosition(inv_view);
+    projection_view = projection * view;
+    projection_scale = projection[1][1];
+
+    // Shared by every program through the uniform buffer.
+    vp_matrix_buffer.update({ projection_view, view_position });
+    inv_projection_view = inverse(projection_view);
+}
+
+void Scene::setOutlineColor(const glm::vec3 &color) {
+    outliner_program.pendUniforms([&, color]() {
+        outliner_uniforms.color.set(color);
+    });
+    object_id_outliner_program.pendUniforms([&, color]() {
+        object_id_outliner_uniforms.color.set(color);
+    });
+}
+
+void Scene::setCursorPosition(std::optional<glm::ivec2> position) {
+    if (recorder) {
+        recorder->record(InputLog::Cursor { position.value_or(glm::ivec2 { 0 }), position.has_value() });
+    }
+    cursor_position = position;
+    if (!position) {
+        hovered_index = no_hover_index;
+        picking_cache.invalidate();
+        return;
+    }
+
+    // Sub-pixel moves are in the same pixel of the same frame, whose value is already read.
+    if (!async_readback && picking_mode != PickingMode::CpuRayCast && !picking_cache.deduplicate(getDrawnPickingQuery(*position))) {
+        readHoveredIndex(*position);
+    }
+    // For asynchronous readback, picking is done in endFrame(), once per frame regardless of how many cursor events
+    // arrived. For CpuRayCast mode, picking is done in update(), after the models are rotated.
+}
+
+void Scene::readHoveredIndex(glm::ivec2 position) {
+    const Profiler::Scope zone { profiler, "picking readback" };
+    frame_statistics.pick_ms = measureMilliseconds([&]() {
+        if (picking_mode == PickingMode::Stencil) {
+            // Read stencil value at the cursor position, store into hovered_index.
+            std::uint8_t stencil;
+            bindDrawnFramebufferForRead();
+            glReadPixels(position.x, position.y, 1, 1, GL_STENCIL_INDEX, GL_UNSIGNED_BYTE, &stencil);
+            hovered_index = stencil != no_hover_stencil && stencil < instances.size() ? stencil : no_hover_index;
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, target_framebuffer);
+        }
+        else {
+            const std::uint32_t object_id = object_id_framebuffer.readObjectId(position);
+            hovered_index = object_id < instances.size() ? object_id : no_hover_index;
+        }
+    });
+}
+
+void Scene::update(float time_delta) {
+    if (recorder) {
+        recordSettings();
+        recorder->record(InputLog::Update { time_delta });
+    }
+
+    asset_loader.processUploads(asset_upload_budget_ms);
+    updateContentVersion();
+
+    // Rotate models along their rotation axis, and get their model/normal matrices. `instances` is also the staging
+    // buffer of the instanced draw, so it is filled in parallel, and the render thread only submits it.
+    // World space bounds are invalidated by the rotation, but recomputed only if BVH is used, in the same chunk while
+    // the matrices are still in cache. If the animation is paused (zero time step), nothing is touched.
+    const bool animated = time_delta != 0.f;
+    const bool bvh_used = picking_mode == PickingMode::CpuRayCast;
+    const bool bounds_outdated = bvh_used && (animated || instance_bounds.isAnyDirty());
+    const bool hierarchical = scene_graph->isHierarchical();
+    if (animated) {
+        ++content_version;
+    }
+    frame_statistics.update_ms = measureMilliseconds([&]() {
+        if (!animated && !bounds_outdated) {
+            return;
+        }
+
+        const Profiler::Scope zone { profiler, "instance update" };
+        const auto update_instances = [&](std::size_t first, std::size_t last) {
+            if (animated) {
+                instance_store.update(time_delta, first, last, instances);
+                instance_bounds.makeDirty(first, last);
+            }
+            if (bvh_used && !hierarchical) {
+                instance_bounds.clean(first, last, [&](std::size_t i, AABB &bounds) {
+                    bounds = mesh_shapes[instance_meshes[i]].bounds.transform(instances[i].model);
+                });
+            }
+        };
+        if (multithreaded_update) {
+            job_system.parallelFor(0, instances.size(), instance_chunk_size, update_instances);
+        }
+        else {
+            update_instances(0, instances.size());
+        }
+
+        // Matrices of the children are relative to their parents until propagated, so the bounds are computed after.
+        if (hierarchical && animated) {
+            propagateTransforms();
+        }
+        if (bvh_used && hierarchical) {
+            const auto clean_bounds = [&](std::size_t first, std::size_t last) {
+                instance_bounds.clean(first, last, [&](std::size_t i, AABB &bounds) {
+                    bounds = mesh_shapes[instance_meshes[i]].bounds.transform(instances[i].model);
+                });
+            };
+            if (multithreaded_update) {
+                job_system.parallelFor(0, instances.size(), instance_chunk_size, clean_bounds);
+            }
+            else {
+                clean_bounds(0, instances.size());
+            }
+        }
+
+        if (bounds_outdated) {
+            // Models are rotated, therefore BVH should be refitted.
+            instance_bvh.refit(instance_bounds.values());
+        }
+    });
+
+    {
+        const Profiler::Scope zone { profiler, "culling" };
+        cullInstances();
+    }
+
+    // Hovered object is updated even if the cursor is not moved, but only if the ray or the instances are changed.
+    if (bvh_used && cursor_position && !picking_cache.deduplicate({ *cursor_position, camera_version, content_version })) {
+        const Profiler::Scope zone { profiler, "ray cast picking" };
+        frame_statistics.pick_ms = measureMilliseconds([&]() {
+            hovered_index = pickByRayCast(*cursor_position);
+        });
+    }
+}
+
+void Scene::propagateTransforms() {
+    // Level by level from the roots, so that the parents are already in world space. Objects of a level are contiguous
+    // and independent of each other.
+    for (const auto &[first, last] : scene_graph->getLevels()) {
+        if (multithreaded_update) {
+            job_system.parallelFor(first, last, instance_chunk_size, [&](std::size_t chunk_first, std::size_t chunk_last) {
+                scene_graph->propagate(instances, chunk_first, chunk_last);
+            });
+        }
+        else {
+            scene_graph->propagate(instances, first, last);
+        }
+    }
+}
+
+void Scene::drawPerObject() const {
+    primary_program.use();
+
+    // Every mesh is in the same vertex array, so only the draw range differs between the draw calls.
+    mesh_pool.bind();
+
+    // Visible indices are sorted by material, so the material uniform is changed only at the boundaries.
+    std::optional<std::uint32_t> current_material_index;
+    for (std::uint32_t idx : visible_indices) {
+        const InstanceData &instance = instances[idx];
+        if (instance.material_index != current_material_index) {
+            primary_uniforms.material_index.set(instance.material_index);
+            current_material_index = instance.material_index;
+        }
+        // Normal matrix is already prepared by the instance update, like the instanced rendering.
+        primary_uniforms.model.set(instance.model);
+        primary_uniforms.normal_matrix.set(instance.normal_matrix);
+        primary_uniforms.object_id.set(idx);
+
+        glStencilFunc(GL_ALWAYS, getStencilReference(idx), 0xFF);
+        mesh_pool.draw(instance_draw_ranges[idx]);
+    }
+    glBindVertexArray(0);
+}
+
+void Scene::drawInstanced() {
+    // Model/normal matrices are already prepared by InstanceStore::update. Only the visible ones are gathered, directly
+    // into the instance buffer, grouped by their draw ranges (mesh and LOD).
+    scene_commands.build(visible_indices, mesh_pool.getDrawRanges(), [&](std::uint32_t idx) {
+        return instance_draw_ranges[idx];
+    });
+    const std::span<const std::uint32_t> instance_order = scene_commands.getInstanceOrder();
+    const std::span<InstanceData> mapped_instances = scene_batch.mapInstances(instance_order.size());
+    for (std::size_t i = 0; i < instance_order.size(); ++i) {
+        mapped_instances[i] = instances[instance_order[i]];
+    }
+    scene_batch.unmapInstances();
+
+    // Object ID is an instance attribute, but stencil reference value cannot be varied per instance. Therefore all objects
+    // are drawn without touching the stencil buffer, with a single multi-draw call (and Stencil picking is not available)...
+    instanced_program.use();
+    glStencilFunc(GL_ALWAYS, no_hover_stencil, 0xFF);
+    scene_batch.draw(scene_commands.getCommands());
+
+    if (!isObjectIdFramebufferUsed() && hovered_index != no_hover_index) {
+        // ...and only the visible fragments of the hovered cube (picked by ray cast) are marked, for the stencil outliner pass.
+        primary_program.use();
+        const InstanceData &instance = instances[hovered_index];
+        primary_uniforms.model.set(instance.model);
+        primary_uniforms.normal_matrix.set(instance.normal_matrix);
+
+        // Same LOD as the instanced draw, so that the depth test passes exactly on the visible fragments.
+        glStencilFunc(GL_ALWAYS, getStencilReference(hovered_index), 0xFF);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthFunc(GL_LEQUAL);
+        mesh_pool.bind();
+        mesh_pool.draw(instance_draw_ranges[hovered_index]);
+        glBindVertexArray(0);
+        glDepthFunc(GL_LESS);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    }
+}
+
+void Scene::draw() {
+    // Settings may be changed after update(), e.g. by the GUI.
+    if (recorder) {
+        recordSettings();
+    }
+    updateContentVersion();
+    drawn_camera_version = camera_version;
+    drawn_content_version = content_version;
+
+    // Bound every frame, since the placeholders are replaced when the loads finish.
+    material_registry.bind(GL_TEXTURE0, GL_TEXTURE1);
+
+    const bool object_id_framebuffer_used = isObjectIdFramebufferUsed();
+    object_id_framebuffer_drawn = object_id_framebuffer_used;
+    if (object_id_framebuffer_used) {
+        object_id_framebuffer.bindAndClear(no_hover_index, no_hover_stencil);
+    }
+    else {
+        glBindFramebuffer(GL_FRAMEBUFFER, target_framebuffer);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+    }
+
+    switch (rendering_mode) {
+        case RenderingMode::PerObject:
+            drawPerObject();
+            break;
+        case RenderingMode::Instanced:
+            drawInstanced();
+            break;
+    }
+
+    if (object_id_framebuffer_used) {
+        // Outline is drawn directly into the target framebuffer.
+        object_id_framebuffer.blitColor(target_framebuffer);
+    }
+
+    if (hovered_index != no_hover_index) {
+        const Profiler::Scope zone { profiler, "outline" };
+
+        // If there is a mesh under the cursor, draw it with slightly scaled model.
+        constexpr float scale_factor = 1.05f;
+
+        assert(hovered_index < instances.size());
+        const glm::mat4 scaled_model = scale(instances[hovered_index].model, glm::vec3 { scale_factor });
+
+        if (object_id_framebuffer_used) {
+            // Fragments whose object ID is hovered_index are discarded in the fragment shader, therefore only scaled
+            // fragments (i.e. outline) of the mesh pass.
+            object_id_outliner_program.use();
+            object_id_outliner_uniforms.model.set(scaled_model);
+            object_id_outliner_uniforms.hovered_id.set(hovered_index);
+            object_id_framebuffer.bindObjectIdTexture(GL_TEXTURE2);
+
+            glStencilFunc(GL_ALWAYS, 0, 0xFF);
+        }
+        else {
+            outliner_program.use();
+            outliner_uniforms.model.set(scaled_model);
+
+            // The stencil function set to GL_NOTEQUAL with reference value = hovered_index will pass only scaled
+            // fragments (i.e. outline) of the mesh.
+            glStencilFunc(GL_NOTEQUAL, static_cast<GLint>(hovered_index), no_hover_stencil);
+        }
+        glStencilMask(0x00);
+        glDisable(GL_DEPTH_TEST);
+
+        // Outline is always LOD 0, which differs from the drawn LOD by less than the LOD error threshold.
+        mesh_pool.bind();
+        mesh_pool.draw(mesh_pool.getMesh(instance_meshes[hovered_index]).first_range);
+        glBindVertexArray(0);
+
+        // Settings should be restored for next render loop.
+        glStencilMask(0xFF);
+        glEnable(GL_DEPTH_TEST);
+    }
+
+    if (!selected_indices.empty()) {
+        const Profiler::Scope zone { profiler, "selection outline" };
+        drawSelectionOutline();
+    }
+}
+
+void Scene::drawSelectionOutline() {
+    // Every selected object is outlined by a single multi-draw call. As the hovered object with object ID framebuffer,
+    // fragments of the scaled object covered by the object itself are discarded, leaving the outline.
+    selection_outline_commands.build(selected_indices, mesh_pool.getDrawRanges(), [&](std::uint32_t idx) {
+        return mesh_pool.getMesh(instance_meshes[idx]).first_range;
+    });
+    const std::span<const std::uint32_t> instance_order = selection_outline_commands.getInstanceOrder();
+    const std::span<InstanceData> mapped_instances = selection_outline_batch.mapInstances(instance_order.size());
+    for (std::size_t i = 0; i < instance_order.size(); ++i) {
+        mapped_instances[i] = instances[instance_order[i]];
+    }
+    selection_outline_batch.unmapInstances();
+
+    selection_outliner_program.use();
+    object_id_framebuffer.bindObjectIdTexture(GL_TEXTURE2);
+
+    glStencilFunc(GL_ALWAYS, 0, 0xFF);
+    glStencilMask(0x00);
+    glDisable(GL_DEPTH_TEST);
+
+    selection_outline_batch.draw(selection_outline_commands.getCommands());
+
+    glStencilMask(0xFF);
+    glEnable(GL_DEPTH_TEST);
+}
+
+void Scene::endFrame() {
+    if (picking_mode != PickingMode::CpuRayCast && async_readback) {
+        // Stencil/object ID buffer is complete after the scene is drawn.
+        const Profiler::Scope zone { profiler, "picking readback" };
+        readbackHoveredIndex();
+    }
+    else if (picking_mode != PickingMode::CpuRayCast && cursor_position && !picking_cache.deduplicate(getDrawnPickingQuery(*cursor_position))) {
+        // Objects may be moved (or the camera) under the still cursor. Read once per frame, only if the frame differs.
+        readHoveredIndex(*cursor_position);
+    }
+    if (occlusion_culling) {
+        const Profiler::Scope zone { profiler, "depth readback" };
+        readbackDepth();
+    }
+    {
+        const Profiler::Scope zone { profiler, "selection readback" };
+        readbackSelection();
+    }
+    ++frame_index;
+
+    if (recorder) {
+        recorder->recordEndFrame(hovered_index);
+    }
+}
+
+void Scene::selectRegion(glm::ivec2 corner1, glm::ivec2 corner2) {
+    if (recorder) {
+        recorder->record(InputLog::SelectRegion { corner1, corner2 });
+    }
+    const glm::ivec2 min = glm::clamp(glm::min(corner1, corner2), glm::ivec2 { 0 }, framebuffer_size - 1);
+    const glm::ivec2 max = glm::clamp(glm::max(corner1, corner2), glm::ivec2 { 0 }, framebuffer_size - 1);
+    pending_selection_region = SelectionRegion { min, max - min + 1 };
+}
+
+void Scene::clearSelection() {
+    if (recorder) {
+        recorder->record(InputLog::ClearSelection {});
+    }
+    pending_selection_region.reset();
+    selected_indices.clear();
+}
+
+void Scene::readbackSelection() {
+    // Reduce the object IDs of the region into the unique ones. Since the number of models may be changed meanwhile, IDs
+    // are validated by ObjectIdSet.
+    selection_readback.consume(frame_index, [&](std::span<const std::byte> data, const PixelReadback::Request&) {
+        ObjectIdSet selection { static_cast<std::uint32_t>(instances.size()) };
+        selection.insert({ reinterpret_cast<const std::uint32_t*>(data.data()), data.size() / sizeof(std::uint32_t) });
+        selected_indices = selection.toVector();
+    });
+
+    if (pending_selection_region && object_id_framebuffer_drawn) {
+        object_id_framebuffer.bindObjectIdForRead();
+        selection_readback.request(frame_index, pending_selection_region->offset, pending_selection_region->extent, GL_RED_INTEGER, GL_UNSIGNED_INT, sizeof(std::uint32_t));
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, target_framebuffer);
+        pending_selection_region.reset();
+    }
+}
+
+void Scene::cullInstances() {
+    visible_indices.clear();
+    if (frustum_culling && scene_graph->isHierarchical()) {
+        // Positions in the store are relative to the parents.
+        scene_graph->cullSpheres(Frustum::fromMatrix(projection_view), mesh_radius, visible_indices);
+    }
+    else if (frustum_culling) {
+        instance_store.cullSpheres(Frustum::fromMatrix(projection_view), mesh_radius, visible_indices);
+    }
+    else {
+        visible_indices.resize(instances.size());
+        std::iota(visible_indices.begin(), visible_indices.end(), 0U);
+    }
+    culling_statistics.num_frustum_culled = instances.size() - visible_indices.size();
+
+    // Roots don't translate, so the position of the sphere is same as the frame where the depth buffer was drawn.
+    // Children orbit their parents, and may be culled for a few frames after they come out from behind an occluder.
+    const std::size_t num_in_frustum = visible_indices.size();
+    if (occlusion_culling && !hi_z_buffer.empty()) {
+        std::erase_if(visible_indices, [&](std::uint32_t idx) {
+            return hi_z_buffer.isOccluded(glm::vec3 { instances[idx].model[3] }, mesh_radius);
+        });
+    }
+    culling_statistics.num_occlusion_culled = num_in_frustum - visible_indices.size();
+    culling_statistics.num_visible = visible_indices.size();
+
+    std::swap(instance_visibilities, previous_instance_visibilities);
+    instance_visibilities.assign(instances.size(), false);
+    for (std::uint32_t idx : visible_indices) {
+        instance_visibilities[idx] = true;
+    }
+    // Hierarchy is rebuilt every frame while occlusion culling is on, but usually culls the same instances under the
+    // still camera. Picked object only changes if the visible set does.
+    if (instance_visibilities != previous_instance_visibilities) {
+        ++content_version;
+    }
+    selectLods();
+
+    // Per object rendering changes the material uniform only when it differs from the previous cube.
+    material_registry.sortByMaterial(visible_indices, [&](std::uint32_t idx) {
+        return instances[idx].material_index;
+    });
+}
+
+void Scene::selectLods() {
+    // Error of a LOD projected at distance d is error * pixels_per_unit / d pixels.
+    const float pixels_per_unit = 0.5f * projection_scale * static_cast<float>(framebuffer_size.y);
+    culling_statistics.num_visible_per_lod.fill(0);
+    culling_statistics.num_triangles = 0;
+
+    instance_draw_ranges.resize(instances.size());
+    for (std::size_t i = 0; i < instances.size(); ++i) {
+        instance_draw_ranges[i] = mesh_pool.getMesh(instance_meshes[i]).first_range;
+    }
+    for (std::uint32_t idx : visible_indices) {
+        const std::span<const DrawRange> lods = mesh_pool.getLods(instance_meshes[idx]);
+        std::uint32_t lod = 0;
+        if (lod_selection) {
+            // Distance to the nearest point of the bounding sphere, so that the error is never underestimated.
+            const float distance = std::max(glm::distance(view_position, glm::vec3 { instances[idx].model[3] }) - mesh_radius, 1e-3f);
+            while (lod + 1U < lods.size() && lods[lod + 1].error * pixels_per_unit <= lod_error_threshold * distance) {
+                ++lod;
+            }
+        }
+        instance_draw_ranges[idx] += lod;
+        ++culling_statistics.num_visible_per_lod[lod];
+        culling_statistics.num_triangles += lods[lod].index_count / 3;
+    }
+}
+
+void Scene::readbackDepth() {
+    // The hierarchy is built from the depth buffer drawn PixelReadback::latency frames ago, with the camera of that frame.
+    depth_readback.consume(frame_index, [&](std::span<const std::byte> data, const PixelReadback::Request &request) {
+        const std::span depths { reinterpret_cast<const float*>(data.data()), data.size() / sizeof(float) };
+        hi_z_buffer.build(depths, request.extent, depth_projection_views[request.frame_index % PixelReadback::ring_size]);
+    });
+
+    bindDrawnFramebufferForRead();
+    depth_readback.request(frame_index, { 0, 0 }, framebuffer_size, GL_DEPTH_COMPONENT, GL_FLOAT, sizeof(float));
+    depth_projection_views[frame_index % PixelReadback::ring_size] = projection_view;
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, target_framebuffer);
+}
+
+void Scene::readbackHoveredIndex() {
+    // Use the value read at least PixelReadback::latency frames ago. By then the GPU already finished the frame, so
+    // mapping the buffer doesn't stall the pipeline. Since the number of models may be changed meanwhile, the index is
+    // validated. A new request is issued only if the pixel or the frame differs from the last request, since the result
+    // of the last one (maybe still in flight) is also the result of the same query.
+    const bool requested = cursor_position && !picking_cache.deduplicate(getDrawnPickingQuery(*cursor_position));
+    if (picking_mode == PickingMode::Stencil) {
+        stencil_readback.consume(frame_index, [&](std::span<const std::byte> data, const PixelReadback::Request&) {
+            const auto stencil = static_cast<std::uint8_t>(data[0]);
+            hovered_index = stencil != no_hover_stencil && stencil < instances.size() ? stencil : no_hover_index;
+        });
+
+        if (requested) {
+            bindDrawnFramebufferForRead();
+            stencil_readback.request(frame_index, *cursor_position, { 1, 1 }, GL_STENCIL_INDEX, GL_UNSIGNED_BYTE, sizeof(std::uint8_t));
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, target_framebuffer);
+        }
+    }
+    else {
+        object_id_readback.consume(frame_index, [&](std::span<const std::byte> data, const PixelReadback::Request&) {
+            std::uint32_t object_id;
+            std::memcpy(&object_id, data.data(), sizeof(object_id));
+            hovered_index = object_id < instances.size() ? object_id : no_hover_index;
+        });
+
+        if (requested) {
+            object_id_framebuffer.bindObjectIdForRead();
+            object_id_readback.request(frame_index, *cursor_position, { 1, 1 }, GL_RED_INTEGER, GL_UNSIGNED_INT, sizeof(std::uint32_t));
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, target_framebuffer);
+        }
+    }
+}
+
+void Scene::setNumCubeInSide(int num) {
+    SceneLayout layout = scene_layout;
+    layout.num_in_side = num;
+    setSceneLayout(layout);
+}
+
+void Scene::setSceneLayout(const SceneLayout &layout) {
+    initModels(layout);
+}
+
+void Scene::bindDrawnFramebufferForRead() const {
+    if (object_id_framebuffer_drawn) {
+        // Depth/stencil attachment is read regardless of the read buffer.
+        object_id_framebuffer.bindObjectIdForRead();
+    }
+    else {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, target_framebuffer);
+    }
+}
+
+void Scene::setOcclusionCulling(bool enabled) noexcept {
+    occlusion_culling = enabled;
+
+    // Depth buffer captured before may be outdated.
+    hi_z_buffer.clear();
+}
+
+void Scene::setRenderingMode(RenderingMode mode) noexcept {
+    rendering_mode = mode;
+    if (mode == RenderingMode::Instanced && picking_mode == PickingMode::Stencil) {
+        setPickingMode(PickingMode::ObjectId);
+    }
+}
+
+void Scene::setPickingMode(PickingMode mode) noexcept {
+    // Every instance is drawn with the same stencil reference, so stencil picking would never find a new hover.
+    picking_mode = mode == PickingMode::Stencil && rendering_mode == RenderingMode::Instanced ? PickingMode::ObjectId : mode;
+    hovered_index = no_hover_index;
+    picking_cache.invalidate();
+}
+
+std::size_t Scene::getNumLods() const noexcept {
+    std::size_t num_lods = 0;
+    for (std::size_t mesh = 0; mesh < mesh_pool.size(); ++mesh) {
+        num_lods = std::max<std::size_t>(num_lods, mesh_pool.getMesh(static_cast<std::uint32_t>(mesh)).lod_count);
+    }
+    return num_lods;
+}
+
+Scene::Settings Scene::getSettings() const noexcept {
+    return {
+        .scene_layout = scene_layout,
+        .rendering_mode = rendering_mode,
+        .picking_mode = picking_mode,
+        .lod_error_threshold = lod_error_threshold,
+        .async_readback = async_readback,
+        .multithreaded_update = multithreaded_update,
+        .persistent_streaming = isPersistentStreaming(),
+        .frustum_culling = frustum_culling,
+        .occlusion_culling = occlusion_culling,
+        .lod_selection = lod_selection,
+    };
+}
+
+void Scene::applySettings(const Settings &settings) {
+    // Setters with side effects are called only if changed.
+    if (settings.scene_layout != scene_layout) {
+        setSceneLayout(settings.scene_layout);
+    }
+    // Rendering mode first, which constrains the picking mode.
+    setRenderingMode(settings.rendering_mode);
+    if (settings.picking_mode != picking_mode) {
+        setPickingMode(settings.picking_mode);
+    }
+    if (settings.persistent_streaming != isPersistentStreaming()) {
+        setPersistentStreaming(settings.persistent_streaming);
+    }
+    if (settings.occlusion_culling != occlusion_culling) {
+        setOcclusionCulling(settings.occlusion_culling);
+    }
+    lod_error_threshold = settings.lod_error_threshold;
+    async_readback = settings.async_readback;
+    multithreaded_update = settings.multithreaded_update;
+    frustum_culling = settings.frustum_culling;
+    lod_selection = settings.lod_selection;
+}
+
+void Scene::setRandomSeed(std::uint32_t seed) {
+    if (recorder) {
+        recorder->record(InputLog::Seed { seed });
+    }
+    random_seed = seed;
+    initModels(scene_layout);
+}
+
+void Scene::setRecorder(InputRecorder *recorder) {
+    this->recorder = recorder;
+    if (!recorder) {
+        return;
+    }
+
+    // Readbacks and the cursor are of the frames before the recording, which cannot be replayed.
+    for (PixelReadback *readback : { &stencil_readback, &object_id_readback, &depth_readback, &selection_readback }) {
+        readback->clear();
+    }
+    cursor_position.reset();
+    picking_cache.invalidate();
+
+    // Initial state, and then the models are re-created from the seed with it.
+    recorded_settings = getSettings();
+    recorder->record(InputLog::Resize { framebuffer_size });
+    recorder->record(recorded_settings);
+    recorder->record(InputLog::Camera { view, projection });
+    setRandomSeed(recorder->getRandomSeed());
+}
+
+void Scene::updateContentVersion() {
+    // Any setting may change what is drawn (e.g. culling, LOD) or how it is picked. Compared as recordSettings().
+    if (const Settings settings = getSettings(); settings != versioned_settings) {
+        ++content_version;
+        versioned_settings = settings;
+    }
+}
+
+PickingCache::Query Scene::getDrawnPickingQuery(glm::ivec2 position) const noexcept {
+    return { position, drawn_camera_version, drawn_content_version };
+}
+
+void Scene::recordSettings() {
+    if (const Settings settings = getSettings(); settings != recorded_settings) {
+        recorder->record(settings);
+        recorded_settings = settings;
+    }
+}
+
+const PixelReadback::Statistics &Scene::getReadbackStatistics() const noexcept {
+    return picking_mode == PickingMode::Stencil ? stencil_readback.getStatistics() : object_id_readback.getStatistics();
+}
+
+void Scene::initModels(const SceneLayout &layout) {
+    // Objects are appended to the store in breadth-first order, with the transforms relative to their parents. Nothing
+    // is changed if the layout is invalid.
+    scene_graph = std::make_unique<SceneGraph>(layout, random_seed, static_cast<std::uint32_t>(material_registry.size()),
+                                               static_cast<std::uint32_t>(mesh_pool.size()), instance_store);
+    scene_layout = layout;
+    instance_meshes = scene_graph->getMeshIndices();
+
+    // Zero time step just writes the initial matrices.
+    instances.resize(instance_store.size());
+    instance_store.update(0.f, instances);
+    if (scene_graph->isHierarchical()) {
+        propagateTransforms();
+    }
+
+    // Build BVH over the world space bounds of the models. It will be refitted (not rebuilt) every frame.
+    instance_bounds.resize(instances.size());
+    instance_bounds.clean([&](std::size_t i, AABB &bounds) {
+        bounds = mesh_shapes[instance_meshes[i]].bounds.transform(instances[i].model);
+    });
+    instance_bvh = Bvh { instance_bounds.values() };
+
+    // Previously hovered model may not exist anymore, and the captured depth buffer is from the old models. Readbacks in
+    // flight are of the old models too, so their object indices must not be consumed.
+    hovered_index = no_hover_index;
+    picking_cache.invalidate();
+    ++content_version;
+    for (PixelReadback *readback : { &stencil_readback, &object_id_readback, &depth_readback, &selection_readback }) {
+        readback->clear();
+    }
+    pending_selection_region.reset();
+    selected_indices.clear();
+    hi_z_buffer.clear();
+    cullInstances();
+}
+
+bool Scene::isObjectIdFramebufferUsed() const noexcept {
+    // CpuRayCast mode doesn't need object ID framebuffer for picking, but the stencil outliner cannot distinguish
+    // objects whose index is no less than no_hover_stencil. Region selection reads and outlines with object IDs.
+    return picking_mode == PickingMode::ObjectId
+        || (picking_mode == PickingMode::CpuRayCast && instances.size() >= no_hover_stencil)
+        || pending_selection_region || !selected_indices.empty();
+}
+
+GLint Scene::getStencilReference(std::uint32_t idx) noexcept {
+    return static_cast<GLint>(idx < no_hover_stencil ? idx : no_hover_stencil);
+}
+
+std::uint32_t Scene::pickByRayCast(const glm::ivec2 &position) const {
+    // Cast a ray through the center of the pixel.
+    const glm::vec2 ndc = 2.f * (glm::vec2 { position } + 0.5f) / glm::vec2 { framebuffer_size } - 1.f;
+    const Ray ray = Ray::fromNdc(ndc, inv_projection_view);
+
+    const auto hit = instance_bvh.closestHit(ray, [&](std::uint32_t instance_index, float t_max) -> std::optional<float> {
+        if (!instance_visibilities[instance_index]) {
+            return std::nullopt; // Not drawn, therefore cannot be under the cursor.
+        }
+
+        // Test the triangles in model's local space, therefore vertices don't have to be transformed.
+        const Ray local_ray = ray.transform(inverse(instances[instance_index].model));
+        const MeshShape &shape = mesh_shapes[instance_meshes[instance_index]];
+
+        std::optional<float> closest;
+        for (std::size_t i = 0; i + 2 < shape.indices.size(); i += 3) {
+            if (auto t = local_ray.intersect(shape.vertices[shape.indices[i]].position, shape.vertices[shape.indices[i + 1]].position, shape.vertices[shape.indices[i + 2]].position, t_max)) {
+                closest = t_max = *t;
+            }
+        }
+        return closest;
+    });
+    return hit ? hit->primitive_index : no_hover_index;
+}
@@ -0,0 +1,448 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <OGLWrapper/Shader.hpp>
+#include <OGLWrapper/Program.hpp>
+
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_int2.hpp>
+
+#include <DirtyPropertyGraph.hpp>
+
+#include "AssetLoader.hpp"
+#include "Bvh.hpp"
+#include "DrawCommandBuilder.hpp"
+#include "HiZBuffer.hpp"
+#include "InstanceData.hpp"
+#include "InstanceStore.hpp"
+#include "JobSystem.hpp"
+#include "MaterialRegistry.hpp"
+#include "MeshFile.hpp"
+#include "MeshPool.hpp"
+#include "MultiDrawBatch.hpp"
+#include "ObjectIdSet.hpp"
+#include "ObjectIdFramebuffer.hpp"
+#include "PickingCache.hpp"
+#include "PixelReadback.hpp"
+#include "Profiler.hpp"
+#include "SceneGraph.hpp"
+#include "TextureCache.hpp"
+#include "Uniform.hpp"
+#include "UniformBlocks.hpp"
+#include "UniformBuffer.hpp"
+#include "Vertex.hpp"
+
+class InputRecorder;
+
+/**
+ * Rotating cubes (and other meshes), and their rendering and picking passes. It doesn't depend on any window, so the same
+ * scene can be driven by \p AppWindow or an offscreen benchmark. Every mesh is packed into a single \p MeshPool. Objects
+ * are generated by a \p SceneGraph from the \p SceneLayout.
+ *
+ * An OpenGL 3.3 context must be current during the lifetime of the scene. Per frame:
+ * @code
+ * scene.setCamera(view, projection); // If changed.
+ * scene.setCursorPosition(cursor);   // If changed. Synchronous picking modes read the pixel here.
+ * scene.update(time_delta);          // Rotate and cull the cubes. CpuRayCast picking is done here.
+ * scene.draw();
+ * scene.endFrame();                  // Asynchronous readbacks, and synchronous picking of the new frame.
+ * @endcode
+ *
+ * Every picking is skipped if the cursor pixel, the camera and the drawn objects are same as the last picking (see
+ * \p PickingCache), so a still cursor over a still scene is picked only once, and a moving scene at most once per frame.
+ */
+class Scene {
+public:
+    enum class RenderingMode : int {
+        PerObject, // Set model uniforms and issue a draw call for each object.
+        Instanced, // Stream model/normal matrices into an instance buffer and draw all objects with a multi-draw call.
+    };
+
+    enum class PickingMode : int {
+        Stencil,    // Read stencil value under the cursor. Only with PerObject rendering.
+        ObjectId,   // Render the scene into ObjectIdFramebuffer and read object ID under the cursor.
+        CpuRayCast, // Unproject the cursor and cast a ray over BVH of the model instances.
+    };
+
+    struct CullingStatistics {
+        std::size_t num_visible = 0;
+        std::size_t num_frustum_culled = 0;
+        std::size_t num_occlusion_culled = 0;
+        std::array<std::size_t, MeshFile::max_lod_count> num_visible_per_lod {};
+        std::size_t num_triangles = 0; // Of the visible instances at their LODs.
+    };
+
+    // Every option that changes what is drawn or picked (and how fast), so that a recorded scene can be configured
+    // identically for the replay.
+    struct Settings {
+        SceneLayout scene_layout;
+        RenderingMode rendering_mode;
+        PickingMode picking_mode;
+        float lod_error_threshold;
+        bool async_readback;
+        bool multithreaded_update;
+        bool persistent_streaming;
+        bool frustum_culling;
+        bool occlusion_culling;
+        bool lod_selection;
+
+        bool operator==(const Settings&) const = default;
+    };
+
+    struct FrameStatistics {
+        float update_ms = 0.f; // CPU time of the instance update (and BVH refit if used) in the last update().
+        float pick_ms = 0.f;   // CPU time of the last synchronous readback or ray cast picking.
+    };
+
+    static constexpr std::uint32_t no_hover_index = 0xFFFFFFFF;
+
+    // Stencil buffer is 8-bit, therefore only objects whose index is less than no_hover_stencil can be distinguished by
+    // stencil picking and outlining. The others are drawn with no_hover_stencil (instead of their index truncated to
+    // 8 bits, which would alias a lower index), so stencil picking never hovers them. Object ID framebuffer is used for
+    // their outlines.
+    static constexpr std::uint8_t no_hover_stencil = 0xFF;
+
+    /**
+     * @param framebuffer_size Size of \p target_framebuffer.
+     * @param target_framebuffer Framebuffer where the scene is finally drawn. It must have color and depth-stencil
+     * attachments. 0 means the default framebuffer.
+     */
+    explicit Scene(glm::ivec2 framebuffer_size, GLuint target_framebuffer = 0);
+
+    void resize(glm::ivec2 framebuffer_size);
+    void setCamera(const glm::mat4 &view, const glm::mat4 &projection);
+    void setOutlineColor(const glm::vec3 &color);
+
+    /**
+     * @brief Set the cursor position used for picking.
+     * @param position Position in OpenGL (bottom-left origined) framebuffer coordinates, or \p std::nullopt if the
+     * cursor is not on the scene.
+     * @note If asynchronous readback is disabled, Stencil/ObjectId picking reads the pixel of the last drawn frame
+     * immediately, unless the pixel is same as the last picked one.
+     */
+    void setCursorPosition(std::optional<glm::ivec2> position);
+
+    void update(float time_delta);
+    void draw();
+    void endFrame();
+
+    /**
+     * @brief Select every object visible in the rectangle. The object IDs of the region are read asynchronously, so the
+     * selection is updated \p PixelReadback::latency frames later.
+     * @param corner1, corner2 Opposite corners of the rectangle (inclusive) in OpenGL framebuffer coordinates.
+     * @note Regardless of the picking mode, the next frame is drawn with the object ID framebuffer.
+     */
+    void selectRegion(glm::ivec2 corner1, glm::ivec2 corner2);
+    void clearSelection();
+    [[nodiscard]] std::span<const std::uint32_t> getSelectedIndices() const noexcept { return selected_indices; }
+
+    [[nodiscard]] int getNumCubeInSide() const noexcept { return scene_layout.num_in_side; }
+    void setNumCubeInSide(int num);
+    [[nodiscard]] const SceneLayout &getSceneLayout() const noexcept { return scene_layout; }
+    /**
+     * @brief Re-create the models with \p layout.
+     * @throw std::runtime_error If the layout is invalid or has too many objects. The models are unchanged then.
+     */
+    void setSceneLayout(const SceneLayout &layout);
+    [[nodiscard]] std::size_t getNumInstances() const noexcept { return instances.size(); }
+    [[nodiscard]] std::uint32_t getHoveredIndex() const noexcept { return hovered_index; }
+
+    [[nodiscard]] RenderingMode getRenderingMode() const noexcept { return rendering_mode; }
+    /**
+     * @brief Set the rendering mode. Instanced rendering cannot write per-object stencil values, therefore Stencil picking
+     * is switched to ObjectId.
+     */
+    void setRenderingMode(RenderingMode mode) noexcept;
+
+    [[nodiscard]] PickingMode getPickingMode() const noexcept { return picking_mode; }
+    /**
+     * @brief Set the picking mode. Stencil is replaced by ObjectId in Instanced rendering mode.
+     */
+    void setPickingMode(PickingMode mode) noexcept;
+
+    [[nodiscard]] bool isAsyncReadback() const noexcept { return async_readback; }
+    void setAsyncReadback(bool enabled) noexcept { async_readback = enabled; }
+    [[nodiscard]] const PixelReadback::Statistics &getReadbackStatistics() const noexcept;
+    [[nodiscard]] const PickingCache::Statistics &getPickingCacheStatistics() const noexcept { return picking_cache.getStatistics(); }
+
+    [[nodiscard]] bool isMultithreadedUpdate() const noexcept { return multithreaded_update; }
+    void setMultithreadedUpdate(bool enabled) noexcept { multithreaded_update = enabled; }
+    [[nodiscard]] std::size_t getNumThreads() const noexcept { return job_system.getNumThreads(); }
+
+    [[nodiscard]] bool isPersistentStreaming() const noexcept { return scene_batch.getInstanceBuffer().isPersistent(); }
+    void setPersistentStreaming(bool enabled) { scene_batch.setPersistent(enabled); }
+    [[nodiscard]] const StreamingBuffer<InstanceData>::Statistics &getInstanceStreamingStatistics() const noexcept {
+        return scene_batch.getInstanceBuffer().getStatistics();
+    }
+    /**
+     * @brief Get the number of draw commands (one per mesh and LOD) of the last instanced draw.
+     */
+    [[nodiscard]] std::size_t getNumDrawCommands() const noexcept { return scene_commands.getCommands().size(); }
+    [[nodiscard]] std::size_t getNumMeshes() const noexcept { return mesh_pool.size(); }
+
+    [[nodiscard]] TextureCache::Statistics getTextureCacheStatistics() const { return texture_cache.getStatistics(); }
+
+    /**
+     * @brief Check whether any asset is still loading. Placeholders are drawn for the loading materials.
+     */
+    [[nodiscard]] bool isLoadingAssets() const noexcept { return asset_loader.getNumPending() != 0; }
+    [[nodiscard]] std::size_t getNumLoadingAssets() const noexcept { return asset_loader.getNumPending(); }
+    /**
+     * @brief Block until every asset is loaded and uploaded.
+     */
+    void waitForAssets() { asset_loader.finish(); }
+
+    [[nodiscard]] bool isFrustumCulling() const noexcept { return frustum_culling; }
+    void setFrustumCulling(bool enabled) noexcept { frustum_culling = enabled; }
+    [[nodiscard]] bool isOcclusionCulling() const noexcept { return occlusion_culling; }
+    void setOcclusionCulling(bool enabled) noexcept;
+    [[nodiscard]] const CullingStatistics &getCullingStatistics() const noexcept { return culling_statistics; }
+
+    /**
+     * @brief Enable the level of detail selection. Each visible object is drawn with the coarsest LOD of its mesh whose
+     * error projected at the object is within \p getLodErrorThreshold() pixels. Picking always uses LOD 0.
+     */
+    [[nodiscard]] bool isLodSelection() const noexcept { return lod_selection; }
+    void setLodSelection(bool enabled) noexcept { lod_selection = enabled; }
+    [[nodiscard]] float getLodErrorThreshold() const noexcept { return lod_error_threshold; }
+    void setLodErrorThreshold(float pixels) noexcept { lod_error_threshold = pixels; }
+    /**
+     * @brief Get the maximum LOD count of the meshes.
+     */
+    [[nodiscard]] std::size_t getNumLods() const noexcept;
+
+    [[nodiscard]] const FrameStatistics &getFrameStatistics() const noexcept { return frame_statistics; }
+
+    [[nodiscard]] Settings getSettings() const noexcept;
+    /**
+     * @brief Apply every setting that differs from the current one. Changing the cube count re-creates the models.
+     */
+    void applySettings(const Settings &settings);
+
+    [[nodiscard]] std::uint32_t getRandomSeed() const noexcept { return random_seed; }
+    /**
+     * @brief Re-create the models with the rotation axes generated from \p seed.
+     */
+    void setRandomSeed(std::uint32_t seed);
+
+    /**
+     * @brief Set the recorder which logs every call that affects the frames (camera, cursor, selection, settings, time
+     * steps and frame ends), or \p nullptr to stop recording. The models are re-created with the seed of the recorder and
+     * the pending readbacks are discarded, so that replaying the log into a new scene reproduces the same frames.
+     * @note Picked objects are reproduced exactly with synchronous picking. Asynchronous readbacks (and occlusion culling)
+     * arrive when the GPU finishes, so they may shift by frames on a different machine.
+     */
+    void setRecorder(InputRecorder *recorder);
+
+    /**
+     * @brief Set the profiler which records the zones inside the scene (outline pass, picking), or \p nullptr to disable.
+     */
+    void setProfiler(Profiler *profiler) noexcept { this->profiler = profiler; }
+
+private:
+    const OGLWrapper::Program primary_program {
+        OGLWrapper::VertexShader { "shaders/cube.vert" },
+        OGLWrapper::FragmentShader { "shaders/cube.frag" }
+    };
+    const OGLWrapper::Program instanced_program {
+        OGLWrapper::VertexShader { "shaders/cube_instanced.vert" },
+        OGLWrapper::FragmentShader { "shaders/cube.frag" }
+    };
+    const OGLWrapper::Program outliner_program {
+        OGLWrapper::VertexShader { "shaders/outliner.vert" },
+        OGLWrapper::FragmentShader { "shaders/outliner.frag" }
+    };
+    const OGLWrapper::Program object_id_outliner_program {
+        OGLWrapper::VertexShader { "shaders/outliner.vert" },
+        OGLWrapper::FragmentShader { "shaders/outliner_id.frag" }
+    };
+    const OGLWrapper::Program selection_outliner_program {
+        OGLWrapper::VertexShader { "shaders/outliner_instanced.vert" },
+        OGLWrapper::FragmentShader { "shaders/outliner_id_instanced.frag" }
+    };
+
+    // Uniform locations of each program, resolved once after linking.
+    const struct {
+        Uniform<glm::mat4> model;
+        Uniform<glm::mat3> normal_matrix;
+        Uniform<GLuint> object_id;
+        Uniform<GLuint> material_index;
+        Uniform<GLint> diffuse_maps;
+        Uniform<GLint> specular_maps;
+    } primary_uniforms {
+        { primary_program, "model" },
+        { primary_program, "normal_matrix" },
+        { primary_program, "object_id" },
+        { primary_program, "material_index" },
+        { primary_program, "diffuse_maps" },
+        { primary_program, "specular_maps" },
+    };
+    const struct {
+        Uniform<GLint> diffuse_maps;
+        Uniform<GLint> specular_maps;
+    } instanced_uniforms {
+        { instanced_program, "diffuse_maps" },
+        { instanced_program, "specular_maps" },
+    };
+    const struct {
+        Uniform<glm::mat4> model;
+        Uniform<glm::vec3> color;
+    } outliner_uniforms {
+        { outliner_program, "model" },
+        { outliner_program, "color" },
+    };
+    const struct {
+        Uniform<glm::mat4> model;
+        Uniform<glm::vec3> color;
+        Uniform<GLint> object_id_map;
+        Uniform<GLuint> hovered_id;
+    } object_id_outliner_uniforms {
+        { object_id_outliner_program, "model" },
+        { object_id_outliner_program, "color" },
+        { object_id_outliner_program, "object_id_map" },
+        { object_id_outliner_program, "hovered_id" },
+    };
+    const struct {
+        Uniform<GLint> object_id_map;
+    } selection_outliner_uniforms {
+        { selection_outliner_program, "object_id_map" },
+    };
+
+    // Shared by every program above.
+    const UniformBuffer<VpMatrix> vp_matrix_buffer;
+    const UniformBuffer<DirectionalLight> light_buffer { DirectionalLight {
+        .direction = glm::vec3 { -1.f },
+        .ambient = glm::vec3 { 0.4f },
+        .diffuse = glm::vec3 { 0.8f },
+        .specular = glm::vec3 { 0.5f },
+    } };
+
+    // Textures are converted to mipmapped (and block compressed, if supported) files at the first run, and later runs
+    // upload them from the memory mapped files. Every material is packed into the texture arrays of the registry, which
+    // are shared by every draw call. Must be declared before `material_registry`.
+    TextureCache texture_cache { "assets/cache" };
+    MaterialRegistry material_registry { texture_cache };
+
+    // Materials are loaded in background threads, and uploaded in update() for at most asset_upload_budget_ms per frame.
+    // Must be declared after `material_registry`, so that no upload runs on the destroyed registry.
+    static constexpr float asset_upload_budget_ms = 2.f;
+    AssetLoader asset_loader;
+
+    // Vertices are read from the memory mapped mesh files without parsing, and used for both GPU upload and the
+    // narrow-phase test of ray cast picking. Files must be declared before `mesh_pool`, since the pool is created from them.
+    std::vector<MeshFile> mesh_files;
+    struct MeshShape {
+        std::span<const VertexPNT> vertices; // In mesh_files.
+        std::vector<std::uint32_t> indices;  // LOD 0.
+        AABB bounds;
+    };
+    std::vector<MeshShape> mesh_shapes; // Indexed by the mesh index, for ray cast picking and the BVH.
+    MeshPool mesh_pool;
+    // Objects of every mesh and LOD are drawn by a batch with a command per (mesh, LOD), built by the command builder.
+    DrawCommandBuilder scene_commands;
+    MultiDrawBatch scene_batch;
+    DrawCommandBuilder selection_outline_commands; // Instances are the selected objects at LOD 0.
+    MultiDrawBatch selection_outline_batch;
+
+    SceneLayout scene_layout;
+    std::uint32_t random_seed = 1; // Of the generated objects, which are generated again at every initModels().
+    std::uint32_t hovered_index = no_hover_index;
+
+    InstanceStore instance_store; // Transforms relative to the parents in scene_graph.
+    std::unique_ptr<SceneGraph> scene_graph;
+    std::vector<InstanceData> instances; // World space model/normal matrices of each object, written by instance_store and scene_graph.
+    std::span<const std::uint32_t> instance_meshes; // Mesh index of each instance, in scene_graph.
+
+    // Culling related properties. Only the instances in visible_indices are drawn and picked.
+    bool frustum_culling = true;
+    // If true, instances hidden behind the depth buffer of PixelReadback::latency frames ago are also culled.
+    bool occlusion_culling = false;
+    float mesh_radius; // Largest bounding sphere radius of the meshes, which is shared by the culling of every instance.
+    std::vector<std::uint32_t> visible_indices;
+    std::vector<std::uint8_t> instance_visibilities; // Whether the instance is in visible_indices, for ray cast picking.
+    std::vector<std::uint8_t> previous_instance_visibilities; // instance_visibilities of the previous cullInstances().
+    std::vector<std::uint32_t> instance_draw_ranges; // Draw range (mesh and LOD) of each instance in this frame, LOD 0 for the culled ones.
+    bool lod_selection = true;
+    float lod_error_threshold = 1.f; // In pixels.
+    HiZBuffer hi_z_buffer;
+    PixelReadback depth_readback;
+    std::array<glm::mat4, PixelReadback::ring_size> depth_projection_views; // Indexed by frame_index % ring_size.
+    CullingStatistics culling_statistics;
+
+    // Instances are updated in chunks of instance_chunk_size (multiple of SIMD width) in parallel.
+    static constexpr std::size_t instance_chunk_size = 4096;
+    JobSystem job_system;
+    bool multithreaded_update = true;
+
+    RenderingMode rendering_mode = RenderingMode::PerObject;
+
+    // Picking related properties.
+    PickingMode picking_mode = PickingMode::Stencil;
+    // If true, Stencil/ObjectId picking reads the pixel into pixel buffer objects once per frame, and uses it after some
+    // frames. Otherwise, read it with glReadPixels (synchronous) at every cursor move.
+    bool async_readback = false;
+    PixelReadback stencil_readback;
+    PixelReadback object_id_readback;
+    GLuint target_framebuffer;
+    glm::ivec2 framebuffer_size;
+    ObjectIdFramebuffer object_id_framebuffer { framebuffer_size };
+    bool object_id_framebuffer_drawn = false; // Whether the last frame is drawn into object_id_framebuffer.
+    std::optional<glm::ivec2> cursor_position; // In OpenGL (bottom-left origined) coordinates.
+    // Picking is skipped if the pixel and the versions are same as the last picking. Versions of the drawn frame are used
+    // for the readbacks, and the current ones for the ray cast.
+    PickingCache picking_cache;
+    std::uint64_t camera_version = 0;
+    std::uint64_t content_version = 0; // Instance transforms, visibilities, framebuffer size and settings.
+    std::uint64_t drawn_camera_version = 0;
+    std::uint64_t drawn_content_version = 0;
+    Settings versioned_settings {}; // Settings when content_version was last checked.
+    DirtyPropertyArray<AABB> instance_bounds; // World space bounds of the instances, derived from their model matrices.
+    Bvh instance_bvh;
+    // Region selection related properties.
+    struct SelectionRegion {
+        glm::ivec2 offset;
+        glm::ivec2 extent;
+    };
+    std::optional<SelectionRegion> pending_selection_region; // Read at the end of the next frame.
+    PixelReadback selection_readback;
+    std::vector<std::uint32_t> selected_indices; // In ascending order.
+
+    glm::mat4 view { 1.f };
+    glm::mat4 projection { 1.f };
+    glm::mat4 projection_view { 1.f };
+    glm::mat4 inv_projection_view { 1.f };
+    glm::vec3 view_position { 0.f };
+    float projection_scale = 1.f; // cot(fov / 2), i.e. projected size of the unit length at the unit distance in NDC.
+
+    std::uint64_t frame_index = 0;
+    FrameStatistics frame_statistics;
+    Profiler *profiler = nullptr;
+    InputRecorder *recorder = nullptr;
+    Settings recorded_settings {}; // Last settings written to the recorder.
+
+    void drawPerObject() const;
+    void drawInstanced();
+    void readbackHoveredIndex();
+    void readHoveredIndex(glm::ivec2 position);
+    void cullInstances();
+    void selectLods();
+    void readbackDepth();
+    void readbackSelection();
+    void drawSelectionOutline();
+    void bindDrawnFramebufferForRead() const;
+    void recordSettings();
+    void updateContentVersion();
+    [[nodiscard]] PickingCache::Query getDrawnPickingQuery(glm::ivec2 position) const noexcept;
+
+    void propagateTransforms();
+
+    void initModels(const SceneLayout &layout);
+
+    [[nodiscard]] bool isObjectIdFramebufferUsed() const noexcept;
+    [[nodiscard]] static GLint getStencilReference(std::uint32_t idx) noexcept;
+    [[nodiscard]] std::uint32_t pickByRayCast(const glm::ivec2 &position) const;
+};
@@ -0,0 +1,172 @@
+#include "SceneGraph.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include <glm/ext/quaternion_float.hpp>
+
+#include <range/v3/view.hpp>
+
+namespace {
+    // Uniformly distributed in [0, 1]. Computed from the raw engine output, since the distributions of the standard
+    // library differ by the implementation.
+    float uniform(std::mt19937 &random_engine) {
+        return static_cast<float>(random_engine()) / 4294967296.f;
+    }
+
+    // Uniformly distributed on the unit sphere.
+    glm::vec3 randomUnitVector(std::mt19937 &random_engine) {
+        const float z = 2.f * uniform(random_engine) - 1.f;
+        const float phi = 2.f * std::numbers::pi_v<float> * uniform(random_engine);
+        const float r = std::sqrt(std::max(1.f - z * z, 0.f));
+        return { r * std::cos(phi), r * std::sin(phi), z };
+    }
+
+    // Bell-shaped in [-1.5, 1.5] with standard deviation 0.5 (sum of three uniforms).
+    float centeredRandom(std::mt19937 &random_engine) {
+        return uniform(random_engine) + uniform(random_engine) + uniform(random_engine) - 1.5f;
+    }
+
+    bool isValid(const SceneLayout &layout) noexcept {
+        return layout.num_in_side >= 1 && layout.hierarchy_depth >= 0 && (layout.hierarchy_depth == 0 || layout.num_children >= 1)
+            && layout.spacing > 0.f;
+    }
+
+    // Every array of the graph, so that the arena needs a single upstream allocation.
+    std::size_t getArenaSize(const SceneLayout &layout) noexcept {
+        if (!isValid(layout) || layout.getNumObjects() > SceneGraph::max_num_objects) {
+            return 0;
+        }
+
+        const auto num_objects = static_cast<std::size_t>(layout.getNumObjects());
+        constexpr std::size_t num_arrays = 6;
+        return sizeof(std::pair<std::size_t, std::size_t>) * static_cast<std::size_t>(layout.hierarchy_depth + 1)
+            + (2 * sizeof(std::uint32_t) + 3 * sizeof(float)) * num_objects
+            + num_arrays * alignof(std::max_align_t); // Padding between the arrays.
+    }
+}
+
+std::uint64_t SceneLayout::getNumObjects() const noexcept {
+    // Saturated just above the limit, so that any layout can be validated without overflow.
+    static constexpr std::uint64_t limit = SceneGraph::max_num_objects + 1;
+    const auto multiply = [](std::uint64_t a, std::uint64_t b) {
+        return a != 0 && b > limit / a ? limit : std::min(a * b, limit);
+    };
+
+    const auto side = static_cast<std::uint64_t>(std::max(num_in_side, 0));
+    std::uint64_t level_size = multiply(multiply(side, side), side);
+    std::uint64_t total = level_size;
+    for (std::int32_t level = 0; level < hierarchy_depth && total < limit; ++level) {
+        level_size = multiply(level_size, static_cast<std::uint64_t>(std::max(num_children, 0)));
+        total = std::min(total + level_size, limit);
+    }
+    return total;
+}
+
+SceneGraph::SceneGraph(const SceneLayout &layout, std::uint32_t random_seed, std::uint32_t num_materials, std::uint32_t num_meshes, InstanceStore &store)
+        : arena { std::max<std::size_t>(getArenaSize(layout), 1) }
+{
+    if (!isValid(layout)) {
+        throw std::runtime_error { "Invalid scene layout" };
+    }
+    if (layout.getNumObjects() > max_num_objects) {
+        throw std::runtime_error { "Scene layout has more than " + std::to_string(max_num_objects) + " objects" };
+    }
+
+    const auto num_objects = static_cast<std::size_t>(layout.getNumObjects());
+    levels.reserve(static_cast<std::size_t>(layout.hierarchy_depth + 1));
+    parents.reserve(num_objects);
+    mesh_indices.reserve(num_objects);
+    for (auto *world : { &world_x, &world_y, &world_z }) {
+        world->resize(num_objects);
+    }
+    store.clear();
+    store.reserve(num_objects);
+
+    // Every object rotates along its random axis with 1 rad/s. Objects depend only on the seed, so that a recorded scene
+    // can be replayed.
+    std::mt19937 random_engine { random_seed };
+    const auto add = [&](const glm::vec3 &position, std::uint32_t parent, std::uint32_t material_index, std::uint32_t mesh_index) {
+        store.push_back(position, glm::quat { 1.f, 0.f, 0.f, 0.f }, randomUnitVector(random_engine), material_index);
+        parents.push_back(parent);
+        mesh_indices.push_back(mesh_index);
+    };
+
+    // Roots, in the volume of the grid centered at the origin.
+    const int n = layout.num_in_side;
+    const float half_extent = 0.5f * layout.spacing * static_cast<float>(n - 1);
+    switch (layout.distribution) {
+        case SceneLayout::Distribution::Grid: {
+            // Materials are assigned in checkerboard pattern, and meshes alternate by the horizontal layers.
+            const auto grid = ranges::views::iota(0, n);
+            for (auto [x, y, z] : ranges::views::cartesian_product(grid, grid, grid)) {
+                const glm::vec3 position = layout.spacing * glm::vec3 { x, y, z } - half_extent;
+                add(position, no_parent, static_cast<std::uint32_t>(x + y + z) % num_materials, static_cast<std::uint32_t>(y) % num_meshes);
+            }
+            break;
+        }
+        case SceneLayout::Distribution::Random:
+        case SceneLayout::Distribution::Clustered: {
+            // n clusters of n² roots, each of which is as dense as the grid.
+            std::vector<glm::vec3> cluster_centers;
+            const float cluster_radius = 0.5f * layout.spacing * std::cbrt(static_cast<float>(n * n));
+            if (layout.distribution == SceneLayout::Distribution::Clustered) {
+                for (int i = 0; i < n; ++i) {
+                    cluster_centers.push_back(half_extent * (2.f * glm::vec3 { uniform(random_engine), uniform(random_engine), uniform(random_engine) } - 1.f));
+                }
+            }
+
+            const std::uint32_t num_roots = static_cast<std::uint32_t>(n) * static_cast<std::uint32_t>(n) * static_cast<std::uint32_t>(n);
+            for (std::uint32_t i = 0; i < num_roots; ++i) {
+                glm::vec3 position;
+                if (cluster_centers.empty()) {
+                    position = half_extent * (2.f * glm::vec3 { uniform(random_engine), uniform(random_engine), uniform(random_engine) } - 1.f);
+                }
+                else {
+                    position = cluster_centers[i % cluster_centers.size()]
+                        + cluster_radius * glm::vec3 { centeredRandom(random_engine), centeredRandom(random_engine), centeredRandom(random_engine) };
+                }
+                add(position, no_parent, i % num_materials, i % num_meshes);
+            }
+            break;
+        }
+    }
+    levels.emplace_back(0, parents.size());
+
+    // Children orbit their parent at the spacing distance. Appending the children of each level in the order of their
+    // parents makes the siblings contiguous, and the next level follows.
+    for (std::int32_t depth = 1; depth <= layout.hierarchy_depth; ++depth) {
+        const auto [first, last] = levels.back();
+        for (std::size_t parent = first; parent < last; ++parent) {
+            for (std::int32_t child = 0; child < layout.num_children; ++child) {
+                add(layout.spacing * randomUnitVector(random_engine), static_cast<std::uint32_t>(parent),
+                    static_cast<std::uint32_t>(depth + child) % num_materials, (mesh_indices[parent] + 1) % num_meshes);
+            }
+        }
+        levels.emplace_back(last, parents.size());
+    }
+    assert(parents.size() == num_objects);
+}
+
+void SceneGraph::propagate(std::span<InstanceData> instances, std::size_t first, std::size_t last) {
+    assert(first <= last && last <= size() && last <= instances.size());
+
+    for (std::size_t i = first; i < last; ++i) {
+        InstanceData &instance = instances[i];
+        if (const std::uint32_t parent = parents[i]; parent != no_parent) {
+            // Objects are not scaled, so the normal matrix is the rotation, which is also composed by multiplication.
+            const InstanceData &parent_instance = instances[parent];
+            instance.model = parent_instance.model * instance.model;
+            instance.normal_matrix = parent_instance.normal_matrix * instance.normal_matrix;
+        }
+        world_x[i] = instance.model[3].x;
+        world_y[i] = instance.model[3].y;
+        world_z[i] = instance.model[3].z;
+    }
+}
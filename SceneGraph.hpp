@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "Geometry.hpp"
+#include "InstanceData.hpp"
+#include "InstanceStore.hpp"
+
+/**
+ * How the objects of a \p SceneGraph are generated.
+ */
+struct SceneLayout {
+    enum class Distribution : std::int32_t {
+        Grid,      // Roots at the points of a cubic grid.
+        Random,    // Roots uniformly distributed in the volume of the grid.
+        Clustered, // Roots gathered around num_in_side random centers in the volume of the grid.
+    };
+
+    Distribution distribution = Distribution::Grid;
+    std::int32_t num_in_side = 6;     // Number of roots is num_in_side³.
+    std::int32_t hierarchy_depth = 0; // Levels of children below each root. 0 means every object is a root.
+    std::int32_t num_children = 2;    // Children of each object above the deepest level.
+    float spacing = 0.8f;             // Distance between the adjacent grid points, and between a child and its parent.
+
+    bool operator==(const SceneLayout&) const = default;
+
+    /**
+     * @brief Get the total number of objects, i.e. the roots and all of their descendants.
+     */
+    [[nodiscard]] std::uint64_t getNumObjects() const noexcept;
+};
+
+/**
+ * Parent/child hierarchy of the rotating objects, generated from a \p SceneLayout.
+ *
+ * Objects are in breadth-first order: the roots first, then the children of every root, then their children, and so on.
+ * Each level is a contiguous index range and every parent precedes its children, so the world transforms are propagated
+ * by a linear sweep per level, whose objects are independent of each other (and can be processed in parallel).
+ *
+ * Every array of the graph is allocated once from a monotonic arena sized for the object count, therefore a graph of
+ * millions of objects is a single upstream allocation, and nothing is allocated afterward.
+ *
+ * @code
+ * InstanceStore store; // Local transforms, relative to the parents.
+ * const SceneGraph graph { layout, random_seed, num_materials, num_meshes, store };
+ * store.update(time_delta, instances);
+ * for (auto [first, last] : graph.getLevels()) {
+ *     graph.propagate(instances, first, last); // instances are in world space after the last level.
+ * }
+ * @endcode
+ */
+class SceneGraph {
+public:
+    static constexpr std::uint32_t no_parent = 0xFFFFFFFF;
+
+    // Object IDs must be distinguishable from Scene::no_hover_index, and the instance data fit in memory.
+    static constexpr std::uint64_t max_num_objects = 1 << 24;
+
+    /**
+     * @brief Generate the objects.
+     * @param layout Layout of the objects.
+     * @param random_seed Seed of the positions (of non-grid distributions, and the children) and the rotation axes.
+     * @param num_materials, num_meshes Number of materials and meshes assigned to the objects.
+     * @param store Cleared, and then the local transforms of the objects are appended in breadth-first order.
+     * @throw std::runtime_error If the layout is invalid or has more than \p max_num_objects objects.
+     */
+    SceneGraph(const SceneLayout &layout, std::uint32_t random_seed, std::uint32_t num_materials, std::uint32_t num_meshes, InstanceStore &store);
+
+    SceneGraph(const SceneGraph&) = delete;
+    SceneGraph &operator=(const SceneGraph&) = delete;
+
+    [[nodiscard]] std::size_t size() const noexcept {
+        return parents.size();
+    }
+
+    [[nodiscard]] bool isHierarchical() const noexcept {
+        return levels.size() > 1;
+    }
+
+    /**
+     * @brief Get the index ranges <tt>[first, last)</tt> of each level, from the roots.
+     */
+    [[nodiscard]] std::span<const std::pair<std::size_t, std::size_t>> getLevels() const noexcept {
+        return levels;
+    }
+
+    /**
+     * @brief Get the parent index of each object, or \p no_parent for the roots.
+     */
+    [[nodiscard]] std::span<const std::uint32_t> getParents() const noexcept {
+        return parents;
+    }
+
+    /**
+     * @brief Get the mesh index of each object.
+     */
+    [[nodiscard]] std::span<const std::uint32_t> getMeshIndices() const noexcept {
+        return mesh_indices;
+    }
+
+    /**
+     * @brief Transform the local matrices in <tt>instances[first, last)</tt> by the world matrices of their parents, and
+     * store their world space positions for \p cullSpheres().
+     * @param instances Matrices written by \p InstanceStore::update(). The parents of the range must already be in world
+     * space, i.e. every level before must be propagated.
+     * @param first, last Range of the object indices, inside a single level.
+     * @note Different ranges of the same level can be propagated concurrently.
+     */
+    void propagate(std::span<InstanceData> instances, std::size_t first, std::size_t last);
+
+    /**
+     * @brief Same as \p InstanceStore::cullSpheres(), with the world space positions of the last \p propagate().
+     */
+    void cullSpheres(const Frustum &frustum, float radius, std::vector<std::uint32_t> &visible_indices) const {
+        InstanceStore::cullSpheres(frustum, radius, world_x, world_y, world_z, visible_indices);
+    }
+
+private:
+    // Must be declared before the arrays, which are allocated from it.
+    std::pmr::monotonic_buffer_resource arena;
+
+    std::pmr::vector<std::pair<std::size_t, std::size_t>> levels { &arena };
+    std::pmr::vector<std::uint32_t> parents { &arena };
+    std::pmr::vector<std::uint32_t> mesh_indices { &arena };
+    std::pmr::vector<float> world_x { &arena }, world_y { &arena }, world_z { &arena };
+};
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+#include <GL/gl3w.h>
+
+/**
+ * Buffer for the data which is rewritten every frame (e.g. per-instance attributes), written directly into the mapped
+ * memory.
+ *
+ * If the context supports \p glBufferStorage (OpenGL 4.4), the buffer is persistently and coherently mapped once, and
+ * split into \p num_regions regions used in round robin. Each region is guarded by a fence, so CPU writes a region only
+ * after the GPU finished the draw calls that read it, and never waits in the common case. Since the region is not at
+ * the beginning of the buffer, the draw call must use \p getBaseElement() as its base instance.
+ *
+ * Otherwise (OpenGL 3.3), the buffer is orphaned and mapped with \p GL_MAP_INVALIDATE_BUFFER_BIT every frame, so the
+ * driver can hand out a fresh storage instead of waiting for the previous draw call.
+ *
+ * @code
+ * std::span<Instance> instances = streaming_buffer.map(count);
+ * // Write instances.
+ * streaming_buffer.unmap();
+ * glDrawElementsInstancedBaseInstance(..., count, streaming_buffer.getBaseElement());
+ * @endcode
+ *
+ * @note Buffer object may be recreated by \p map() when it grows, therefore the vertex attribute pointers should be
+ * specified again if \p getStorageVersion() is changed. Handle may be same as the deleted one.
+ */
+template <typename T> requires std::is_trivially_copyable_v<T>
+class StreamingBuffer {
+public:
+    static constexpr std::size_t num_regions = 3;
+
+    struct Statistics {
+        std::uint64_t num_maps = 0;
+        std::uint64_t num_stalls = 0; // How many times map() had to wait for the GPU to finish reading the region.
+        float stall_ms = 0.f;         // Total time spent by the waits.
+    };
+
+    explicit StreamingBuffer(GLenum target = GL_ARRAY_BUFFER) : target { target } {
+        setPersistent(true);
+    }
+
+    StreamingBuffer(const StreamingBuffer&) = delete;
+    StreamingBuffer &operator=(const StreamingBuffer&) = delete;
+
+    ~StreamingBuffer() {
+        release();
+    }
+
+    [[nodiscard]] static bool isPersistentMappingSupported() {
+        // Base instance (4.2) is also required to draw from the regions.
+        return gl3wIsSupported(4, 4);
+    }
+
+    [[nodiscard]] bool isPersistent() const noexcept {
+        return persistent;
+    }
+
+    /**
+     * @brief Select between the persistently mapped ring and the orphaning. Storage is released and recreated at the next
+     * \p map().
+     * @param enabled If \p true and supported, persistent mapping is used.
+     */
+    void setPersistent(bool enabled) {
+        release();
+        persistent = enabled && isPersistentMappingSupported();
+    }
+
+    [[nodiscard]] GLuint getHandle() const noexcept {
+        return buffer;
+    }
+
+    /**
+     * @brief Get the count of buffer object creations.
+     */
+    [[nodiscard]] std::uint64_t getStorageVersion() const noexcept {
+        return storage_version;
+    }
+
+    /**
+     * @brief Get the index of the first element written by the last \p map(), which must be passed as the base instance.
+     */
+    [[nodiscard]] GLuint getBaseElement() const noexcept {
+        return static_cast<GLuint>(current_region * region_capacity);
+    }
+
+    /**
+     * @brief Get writable memory for \p count elements, which will be read by the draw calls of this frame.
+     * @param count Number of elements.
+     * @return Write-only memory. Reading from it may be very slow.
+     * @note The region written by the previous call is fenced here, after every draw call that reads it has been issued.
+     */
+    [[nodiscard]] std::span<T> map(std::size_t count) {
+        ++statistics.num_maps;
+        if (persistent) {
+            return mapPersistent(count);
+        }
+
+        if (!buffer) {
+            glGenBuffers(1, &buffer);
+            ++storage_version;
+        }
+        glBindBuffer(target, buffer);
+        region_capacity = std::max(region_capacity, count);
+        // Orphan the previous storage, which may still be read by the GPU.
+        glBufferData(target, static_cast<GLsizeiptr>(region_capacity * sizeof(T)), nullptr, GL_STREAM_DRAW);
+        void *const data = count == 0 ? nullptr : glMapBufferRange(target, 0, static_cast<GLsizeiptr>(count * sizeof(T)), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        is_mapped = data != nullptr;
+        return { static_cast<T*>(data), count };
+    }
+
+    /**
+     * @brief Finish writing of the memory returned by \p map().
+     */
+    void unmap() {
+        if (!persistent && is_mapped) {
+            glBindBuffer(target, buffer);
+            glUnmapBuffer(target);
+            is_mapped = false;
+        }
+        glBindBuffer(target, 0);
+    }
+
+    [[nodiscard]] const Statistics &getStatistics() const noexcept {
+        return statistics;
+    }
+
+private:
+    GLenum target;
+    bool persistent = false;
+    GLuint buffer = 0;
+    std::uint64_t storage_version = 0;
+    std::size_t region_capacity = 0; // In elements.
+    std::size_t current_region = 0;
+    bool is_mapped = false;
+    T *mapped_data = nullptr; // Persistently mapped whole buffer.
+    std::array<GLsync, num_regions> fences {};
+    Statistics statistics;
+
+    std::span<T> mapPersistent(std::size_t count) {
+        if (buffer) {
+            fences[current_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            current_region = (current_region + 1) % num_regions;
+        }
+
+        if (count > region_capacity) {
+            // Immutable storage cannot be resized, so a new buffer is created. Growth is geometric to not recreate it
+            // every frame while the count increases.
+            const std::size_t new_capacity = std::max(count, 2 * region_capacity);
+            release();
+            region_capacity = new_capacity;
+
+            glGenBuffers(1, &buffer);
+            ++storage_version;
+            glBindBuffer(target, buffer);
+            constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            const auto size = static_cast<GLsizeiptr>(num_regions * region_capacity * sizeof(T));
+            glBufferStorage(target, size, nullptr, flags);
+            mapped_data = static_cast<T*>(glMapBufferRange(target, 0, size, flags));
+        }
+
+        if (GLsync &fence = fences[current_region]) {
+            if (const GLenum result = glClientWaitSync(fence, 0, 0); result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) {
+                // GPU is more than num_regions - 1 frames behind.
+                const auto start = std::chrono::steady_clock::now();
+                glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+                statistics.stall_ms += std::chrono::duration<float, std::milli> { std::chrono::steady_clock::now() - start }.count();
+                ++statistics.num_stalls;
+            }
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+
+        return { mapped_data + current_region * region_capacity, count };
+    }
+
+    void release() {
+        for (GLsync &fence : fences) {
+            if (fence) {
+                // Storage may still be read by the GPU.
+                glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+                glDeleteSync(fence);
+                fence = nullptr;
+            }
+        }
+        if (buffer) {
+            if (mapped_data) {
+                glBindBuffer(target, buffer);
+                glUnmapBuffer(target);
+                glBindBuffer(target, 0);
+                mapped_data = nullptr;
+            }
+            glDeleteBuffers(1, &buffer);
+            buffer = 0;
+        }
+        region_capacity = 0;
+        current_region = 0;
+    }
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <utility>
+
+#include <GL/gl3w.h>
+
+/**
+ * Owning handle of a 2D texture object. Storage is specified by the creator, e.g. \p TextureCache.
+ */
+class Texture2D {
+    GLuint handle;
+
+public:
+    Texture2D() {
+        glGenTextures(1, &handle);
+    }
+
+    ~Texture2D() {
+        if (handle) {
+            glDeleteTextures(1, &handle);
+        }
+    }
+
+    Texture2D(const Texture2D&) = delete;
+    Texture2D &operator=(const Texture2D&) = delete;
+
+    Texture2D(Texture2D &&other) noexcept : handle { std::exchange(other.handle, 0) } {
+
+    }
+
+    Texture2D &operator=(Texture2D &&other) noexcept {
+        std::swap(handle, other.handle);
+        return *this;
+    }
+
+    [[nodiscard]] GLuint getHandle() const noexcept {
+        return handle;
+    }
+
+    void bind() const {
+        glBindTexture(GL_TEXTURE_2D, handle);
+    }
+};
@@ -0,0 +1,169 @@
+#include "TextureCache.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Static, so that it doesn't collide with the stb_image implementation of other libraries (e.g. OGLWrapper).
+#define STB_IMAGE_STATIC
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+namespace {
+    // 64-bit FNV-1a.
+    std::uint64_t hashBytes(std::span<const std::byte> bytes, std::uint64_t hash = 0xCBF29CE484222325) {
+        for (std::byte byte : bytes) {
+            hash = (hash ^ static_cast<std::uint64_t>(byte)) * 0x100000001B3;
+        }
+        return hash;
+    }
+
+    // Bumped when the conversion changes its result, to invalidate the cache files of the previous conversion.
+    constexpr std::uint32_t conversion_revision = 2;
+
+    // Decode the image into RGBA8 rows from bottom to top, which is the order of OpenGL. Only uses CPU, so that it can
+    // run on any thread.
+    ImageLevel decodeImage(std::span<const std::byte> bytes, const std::filesystem::path &path) {
+        int width, height, num_channels;
+        stbi_uc *const pixels = stbi_load_from_memory(
+            reinterpret_cast<const stbi_uc*>(bytes.data()), static_cast<int>(bytes.size()),
+            &width, &height, &num_channels, STBI_rgb_alpha);
+        if (!pixels) {
+            throw std::runtime_error { "Failed to decode " + path.string() + ": " + stbi_failure_reason() };
+        }
+
+        ImageLevel image { { width, height }, {} };
+        const std::size_t row_size = 4 * static_cast<std::size_t>(width);
+        image.pixels.resize(row_size * static_cast<std::size_t>(height));
+        for (int y = 0; y < height; ++y) {
+            const stbi_uc *const row = pixels + row_size * static_cast<std::size_t>(height - 1 - y);
+            std::copy_n(row, row_size, image.pixels.begin() + static_cast<std::ptrdiff_t>(row_size * static_cast<std::size_t>(y)));
+        }
+        stbi_image_free(pixels);
+        return image;
+    }
+
+    void setSamplerParameters(GLint max_level) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, max_level);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    }
+
+    Texture2D upload(const TextureFile &file) {
+        const TextureFile::Header &header = file.getHeader();
+        const GLenum internal_format = TextureFile::getInternalFormat(header.format);
+
+        Texture2D texture;
+        texture.bind();
+        for (std::uint32_t level = 0; level < header.level_count; ++level) {
+            const auto width = static_cast<GLsizei>(header.levels[level].width);
+            const auto height = static_cast<GLsizei>(header.levels[level].height);
+            const std::span data = file.getLevelData(level);
+            if (header.format == TextureFile::Format::Rgba8) {
+                glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
+            }
+            else {
+                glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), internal_format, width, height, 0, static_cast<GLsizei>(data.size()), data.data());
+            }
+        }
+        setSamplerParameters(static_cast<GLint>(header.level_count) - 1);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return texture;
+    }
+}
+
+TextureCache::TextureCache(std::filesystem::path directory)
+    : TextureCache { std::move(directory), isBlockCompressionSupported() } {
+
+}
+
+TextureCache::TextureCache(std::filesystem::path directory, bool block_compression)
+    : directory { std::move(directory) }, block_compression { block_compression } {
+
+}
+
+Texture2D TextureCache::load(const std::filesystem::path &source_path) {
+    return upload(loadFile(source_path));
+}
+
+TextureFile TextureCache::loadFile(const std::filesystem::path &source_path) {
+    const auto start = std::chrono::steady_clock::now();
+    TextureFile file = loadFileUntimed(source_path);
+    const float elapsed_ms = std::chrono::duration<float, std::milli> { std::chrono::steady_clock::now() - start }.count();
+
+    std::lock_guard lock { statistics_mutex };
+    statistics.load_ms += elapsed_ms;
+    return file;
+}
+
+TextureFile TextureCache::loadFileUntimed(const std::filesystem::path &source_path) {
+    // Key also depends on the container version, the conversion and the compression support, which decide the content.
+    const MappedFile source_file { source_path };
+    const std::uint64_t source_hash = hashBytes(source_file.getBytes());
+    const std::uint32_t key_seed[] = { TextureFile::version, conversion_revision, block_compression };
+    const std::uint64_t key = hashBytes(std::as_bytes(std::span { key_seed }), source_hash);
+
+    char key_string[16];
+    const std::string_view key_hex { key_string, std::to_chars(std::begin(key_string), std::end(key_string), key, 16).ptr };
+    const std::filesystem::path cache_path = directory / (source_path.stem().string() + '-' + std::string { key_hex } + ".tex");
+
+    if (std::error_code error; std::filesystem::exists(cache_path, error)) {
+        try {
+            TextureFile file { cache_path };
+            if (file.getHeader().source_hash == source_hash) {
+                std::lock_guard lock { statistics_mutex };
+                ++statistics.num_hits;
+                return file;
+            }
+        }
+        catch (const std::runtime_error&) {
+            // Corrupted or stale, converted again below.
+        }
+    }
+
+    {
+        std::lock_guard lock { statistics_mutex };
+        ++statistics.num_misses;
+    }
+    const ImageLevel image = decodeImage(source_file.getBytes(), source_path);
+    const std::vector levels = generateMipChain(image.pixels, image.size);
+    const TextureFile::Format format = !block_compression ? TextureFile::Format::Rgba8
+        : isOpaque(image.pixels) ? TextureFile::Format::Bc1 : TextureFile::Format::Bc3;
+
+    std::vector bytes = TextureFile::encode(format, source_hash, levels);
+
+    // Written to a temporary file first, so that other process never maps a partially written file. Its name is unique,
+    // since the same image may be converted by multiple threads at once (the last rename wins with the same content).
+    std::filesystem::path temporary_path = cache_path;
+    temporary_path += '.' + std::to_string(temporary_file_counter.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+    try {
+        std::filesystem::create_directories(directory);
+        TextureFile::write(temporary_path, bytes);
+        std::filesystem::rename(temporary_path, cache_path);
+        return TextureFile { cache_path };
+    }
+    catch (const std::runtime_error&) {
+        // Cache directory may be read-only. The converted levels are used from memory, and converted again next run.
+        std::error_code error;
+        std::filesystem::remove(temporary_path, error);
+        return TextureFile { std::move(bytes) };
+    }
+}
+
+bool TextureCache::isBlockCompressionSupported() {
+    GLint num_extensions;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &num_extensions);
+    for (GLint i = 0; i < num_extensions; ++i) {
+        const auto *extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        if (extension && std::string_view { extension } == "GL_EXT_texture_compression_s3tc") {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+
+#include "Texture2D.hpp"
+#include "TextureFile.hpp"
+
+/**
+ * Loads image files as mipmapped textures through a directory of \p TextureFile. The first load of an image decodes it,
+ * generates its mip chain, encodes it (BC1 for opaque images, BC3 otherwise, or RGBA8 if S3TC is not supported) and
+ * stores the result; later loads, including ones of later runs, upload the memory mapped levels directly. If the cache
+ * file cannot be written (e.g. read-only directory), the converted levels are kept in memory instead.
+ *
+ * Cache files are keyed by the hash of the source file content, so modified images are converted again.
+ *
+ * \p loadFile() only uses CPU, and is safe to be called from multiple threads at once. Construction and \p load() must
+ * be done in the thread of the OpenGL context.
+ *
+ * @code
+ * TextureCache texture_cache { "assets/cache" };
+ * Texture2D diffuse_map = texture_cache.load("assets/textures/container2.png");
+ * @endcode
+ */
+class TextureCache {
+public:
+    struct Statistics {
+        std::uint32_t num_hits = 0;
+        std::uint32_t num_misses = 0;
+        float load_ms = 0.f; // Total time spent by load().
+    };
+
+    /**
+     * @param directory Directory of the cache files. Created at the first conversion.
+     * @note The current OpenGL context decides whether the block compression is used.
+     */
+    explicit TextureCache(std::filesystem::path directory);
+
+    /**
+     * @param directory Directory of the cache files. Created at the first conversion.
+     * @param block_compression Whether the images are encoded to BC1/BC3. It doesn't need an OpenGL context, so
+     * \p loadFile() can be used without any (e.g. offline conversion or tests).
+     */
+    TextureCache(std::filesystem::path directory, bool block_compression);
+
+    /**
+     * @brief Load the image as a mipmapped texture with trilinear filtering and repeat wrapping.
+     * @param source_path Path of the image file.
+     * @throw std::runtime_error If the image file cannot be read or decoded.
+     */
+    [[nodiscard]] Texture2D load(const std::filesystem::path &source_path);
+
+    /**
+     * @brief Get the memory mapped cache file of the image, converting it if not cached yet. Use this to upload the
+     * levels into other texture (e.g. a layer of texture array). Thread safe.
+     * @param source_path Path of the image file.
+     * @return Memory mapped cache file, or the converted content in memory if the cache file cannot be written.
+     * @throw std::runtime_error If the image file cannot be read or decoded.
+     */
+    [[nodiscard]] TextureFile loadFile(const std::filesystem::path &source_path);
+
+    [[nodiscard]] Statistics getStatistics() const {
+        std::lock_guard lock { statistics_mutex };
+        return statistics;
+    }
+
+    /**
+     * @brief Check whether the context supports S3TC (\p GL_EXT_texture_compression_s3tc), which is required for
+     * BC1/BC3 formats.
+     */
+    [[nodiscard]] static bool isBlockCompressionSupported();
+
+private:
+    std::filesystem::path directory;
+    bool block_compression;
+
+    mutable std::mutex statistics_mutex;
+    Statistics statistics;
+
+    std::atomic<std::uint32_t> temporary_file_counter = 0;
+
+    [[nodiscard]] TextureFile loadFileUntimed(const std::filesystem::path &source_path);
+};
@@ -0,0 +1,207 @@
+#include "TextureEncoder.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/ext/matrix_float3x3.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_int3.hpp>
+#include <glm/ext/vector_uint4_sized.hpp>
+
+namespace {
+    using Block = std::array<glm::u8vec4, 16>;
+
+    // 4x4 pixels whose top-left is (x, y). Pixels outside the image are clamped, so they don't affect the endpoints.
+    Block loadBlock(std::span<const std::uint8_t> pixels, glm::ivec2 size, int x, int y) {
+        Block block;
+        for (int j = 0; j < 4; ++j) {
+            const int py = std::min(y + j, size.y - 1);
+            for (int i = 0; i < 4; ++i) {
+                const int px = std::min(x + i, size.x - 1);
+                std::memcpy(&block[4 * j + i], &pixels[4 * (static_cast<std::size_t>(py) * size.x + px)], 4);
+            }
+        }
+        return block;
+    }
+
+    std::uint16_t toRgb565(const glm::vec3 &color) {
+        const glm::ivec3 quantized = glm::clamp(glm::ivec3 { color * glm::vec3 { 31.f, 63.f, 31.f } / 255.f + 0.5f }, glm::ivec3 { 0 }, glm::ivec3 { 31, 63, 31 });
+        return static_cast<std::uint16_t>(quantized.r << 11 | quantized.g << 5 | quantized.b);
+    }
+
+    glm::vec3 fromRgb565(std::uint16_t color) {
+        const int r = color >> 11 & 31, g = color >> 5 & 63, b = color & 31;
+        return glm::vec3 { glm::ivec3 { r << 3 | r >> 2, g << 2 | g >> 4, b << 3 | b >> 2 } };
+    }
+
+    // Principal axis of the colors by power iteration on their covariance.
+    glm::vec3 getPrincipalAxis(const std::array<glm::vec3, 16> &colors) {
+        glm::vec3 mean { 0.f };
+        for (const glm::vec3 &color : colors) {
+            mean += color;
+        }
+        mean /= 16.f;
+
+        glm::mat3 covariance { 0.f };
+        for (const glm::vec3 &color : colors) {
+            const glm::vec3 d = color - mean;
+            covariance += glm::mat3 { d * d.x, d * d.y, d * d.z };
+        }
+
+        // Seed with the covariance row of the largest norm. A fixed seed fails for variation orthogonal to it, e.g. (1, 1, 1)
+        // is orthogonal to the chroma variation of an equal luminance block, whose covariance maps it to zero.
+        glm::vec3 axis = covariance[0];
+        for (int row = 1; row < 3; ++row) {
+            if (dot(covariance[row], covariance[row]) > dot(axis, axis)) {
+                axis = covariance[row];
+            }
+        }
+        if (dot(axis, axis) < 1e-12f) {
+            return glm::vec3 { 1.f }; // Uniform block, any axis works.
+        }
+
+        for (int iteration = 0; iteration < 8; ++iteration) {
+            const glm::vec3 next = covariance * axis;
+            const float length = glm::length(next);
+            if (length < 1e-6f) {
+                break;
+            }
+            axis = next / length;
+        }
+        return axis;
+    }
+
+    void encodeColorBlock(const Block &block, std::byte *output) {
+        std::array<glm::vec3, 16> colors;
+        std::ranges::transform(block, colors.begin(), [](const glm::u8vec4 &pixel) { return glm::vec3 { pixel }; });
+
+        // Extremes along the principal axis, inset by 1/16 of the range to reduce the error of the inner colors.
+        const glm::vec3 axis = getPrincipalAxis(colors);
+        const auto [min_it, max_it] = std::ranges::minmax_element(colors, {}, [&](const glm::vec3 &color) { return dot(color, axis); });
+        const glm::vec3 inset = (*max_it - *min_it) / 16.f;
+        std::uint16_t color0 = toRgb565(*max_it - inset), color1 = toRgb565(*min_it + inset);
+
+        // color0 > color1 selects the 4 color mode.
+        if (color0 < color1) {
+            std::swap(color0, color1);
+        }
+
+        std::uint32_t indices = 0;
+        if (color0 != color1) {
+            const glm::vec3 endpoint0 = fromRgb565(color0), endpoint1 = fromRgb565(color1);
+            const std::array palette { endpoint0, endpoint1, (2.f * endpoint0 + endpoint1) / 3.f, (endpoint0 + 2.f * endpoint1) / 3.f };
+            for (std::size_t i = 0; i < colors.size(); ++i) {
+                std::uint32_t best_index = 0;
+                float best_distance = std::numeric_limits<float>::max();
+                for (std::uint32_t index = 0; index < palette.size(); ++index) {
+                    const glm::vec3 d = colors[i] - palette[index];
+                    if (const float distance = dot(d, d); distance < best_distance) {
+                        best_distance = distance;
+                        best_index = index;
+                    }
+                }
+                indices |= best_index << (2 * i);
+            }
+        }
+
+        std::memcpy(output, &color0, 2);
+        std::memcpy(output + 2, &color1, 2);
+        std::memcpy(output + 4, &indices, 4);
+    }
+
+    void encodeAlphaBlock(const Block &block, std::byte *output) {
+        const auto [min_it, max_it] = std::ranges::minmax_element(block, {}, [](const glm::u8vec4 &pixel) { return pixel.a; });
+        const std::uint8_t alpha0 = max_it->a, alpha1 = min_it->a;
+
+        // alpha0 > alpha1 selects the 8 alpha mode.
+        std::uint64_t indices = 0;
+        if (alpha0 != alpha1) {
+            std::array<int, 8> palette { alpha0, alpha1 };
+            for (int i = 2; i < 8; ++i) {
+                palette[i] = ((8 - i) * alpha0 + (i - 1) * alpha1) / 7;
+            }
+            for (std::size_t i = 0; i < block.size(); ++i) {
+                const auto best = std::ranges::min_element(palette, {}, [&](int alpha) { return std::abs(alpha - block[i].a); });
+                indices |= static_cast<std::uint64_t>(best - palette.begin()) << (3 * i);
+            }
+        }
+
+        output[0] = std::byte { alpha0 };
+        output[1] = std::byte { alpha1 };
+        for (int i = 0; i < 6; ++i) {
+            output[2 + i] = static_cast<std::byte>(indices >> (8 * i));
+        }
+    }
+
+    template <std::size_t BlockBytes, typename F>
+    std::vector<std::byte> encodeBlocks(std::span<const std::uint8_t> pixels, glm::ivec2 size, F &&encode_block) {
+        assert(pixels.size() == 4 * static_cast<std::size_t>(size.x) * static_cast<std::size_t>(size.y));
+
+        std::vector<std::byte> blocks(getBlockCompressedSize(size, BlockBytes));
+        std::byte *output = blocks.data();
+        for (int y = 0; y < size.y; y += 4) {
+            for (int x = 0; x < size.x; x += 4) {
+                encode_block(loadBlock(pixels, size, x, y), output);
+                output += BlockBytes;
+            }
+        }
+        return blocks;
+    }
+}
+
+std::vector<ImageLevel> generateMipChain(std::span<const std::uint8_t> pixels, glm::ivec2 size) {
+    assert(pixels.size() == 4 * static_cast<std::size_t>(size.x) * static_cast<std::size_t>(size.y));
+
+    std::vector<ImageLevel> levels;
+    levels.push_back({ size, { pixels.begin(), pixels.end() } });
+    while (levels.back().size != glm::ivec2 { 1 }) {
+        const ImageLevel &source = levels.back();
+        ImageLevel level { glm::max(source.size / 2, glm::ivec2 { 1 }), {} };
+        level.pixels.resize(4 * static_cast<std::size_t>(level.size.x) * static_cast<std::size_t>(level.size.y));
+        for (int y = 0; y < level.size.y; ++y) {
+            const int y0 = std::min(2 * y, source.size.y - 1), y1 = std::min(2 * y + 1, source.size.y - 1);
+            for (int x = 0; x < level.size.x; ++x) {
+                const int x0 = std::min(2 * x, source.size.x - 1), x1 = std::min(2 * x + 1, source.size.x - 1);
+                for (int channel = 0; channel < 4; ++channel) {
+                    const auto texel = [&](int tx, int ty) {
+                        return source.pixels[4 * (static_cast<std::size_t>(ty) * source.size.x + tx) + channel];
+                    };
+                    level.pixels[4 * (static_cast<std::size_t>(y) * level.size.x + x) + channel]
+                        = static_cast<std::uint8_t>((texel(x0, y0) + texel(x1, y0) + texel(x0, y1) + texel(x1, y1) + 2) / 4);
+                }
+            }
+        }
+        levels.push_back(std::move(level));
+    }
+    return levels;
+}
+
+bool isOpaque(std::span<const std::uint8_t> pixels) noexcept {
+    for (std::size_t i = 3; i < pixels.size(); i += 4) {
+        if (pixels[i] != 255) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::size_t getBlockCompressedSize(glm::ivec2 size, std::size_t block_bytes) noexcept {
+    return static_cast<std::size_t>((size.x + 3) / 4) * static_cast<std::size_t>((size.y + 3) / 4) * block_bytes;
+}
+
+std::vector<std::byte> encodeBc1(std::span<const std::uint8_t> pixels, glm::ivec2 size) {
+    return encodeBlocks<8>(pixels, size, encodeColorBlock);
+}
+
+std::vector<std::byte> encodeBc3(std::span<const std::uint8_t> pixels, glm::ivec2 size) {
+    return encodeBlocks<16>(pixels, size, [](const Block &block, std::byte *output) {
+        encodeAlphaBlock(block, output);
+        encodeColorBlock(block, output + 8);
+    });
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/ext/vector_int2.hpp>
+
+/**
+ * Offline texture processing, which turns a decoded RGBA8 image into the mip levels that can be uploaded to GPU without
+ * any runtime work. Everything here is CPU only.
+ *
+ * @code
+ * std::vector<ImageLevel> levels = generateMipChain(pixels, size);
+ * for (ImageLevel &level : levels) {
+ *     std::vector<std::byte> blocks = encodeBc1(level.pixels, level.size);
+ * }
+ * @endcode
+ */
+struct ImageLevel {
+    glm::ivec2 size;
+    std::vector<std::uint8_t> pixels; // RGBA8, tightly packed rows.
+};
+
+/**
+ * @brief Build the full mip chain down to 1x1 with 2x2 box filter. Last row/column of odd sized level is clamped.
+ * @param pixels RGBA8 pixels of the base level.
+ * @param size Size of the base level.
+ * @return Levels from the base level (copied) to 1x1.
+ */
+[[nodiscard]] std::vector<ImageLevel> generateMipChain(std::span<const std::uint8_t> pixels, glm::ivec2 size);
+
+/**
+ * @brief Check whether every pixel has alpha of 255, i.e. the image can be encoded without alpha.
+ */
+[[nodiscard]] bool isOpaque(std::span<const std::uint8_t> pixels) noexcept;
+
+/**
+ * @brief Get the byte size of the block compressed image.
+ * @param size Image size. Partial blocks at the right/top edge are counted as whole.
+ * @param block_bytes 8 for BC1, 16 for BC3.
+ */
+[[nodiscard]] std::size_t getBlockCompressedSize(glm::ivec2 size, std::size_t block_bytes) noexcept;
+
+/**
+ * @brief Encode the image as BC1 (DXT1) without alpha, 8 bytes per 4x4 block. Endpoints are fit along the principal
+ * axis of each block's colors.
+ * @param pixels RGBA8 pixels. Alpha is ignored.
+ * @param size Image size.
+ * @return Blocks in row-major order, which can be passed to \p glCompressedTexImage2D.
+ */
+[[nodiscard]] std::vector<std::byte> encodeBc1(std::span<const std::uint8_t> pixels, glm::ivec2 size);
+
+/**
+ * @brief Encode the image as BC3 (DXT5), 16 bytes per 4x4 block: interpolated alpha block followed by BC1 color block.
+ * @param pixels RGBA8 pixels.
+ * @param size Image size.
+ * @return Blocks in row-major order, which can be passed to \p glCompressedTexImage2D.
+ */
+[[nodiscard]] std::vector<std::byte> encodeBc3(std::span<const std::uint8_t> pixels, glm::ivec2 size);
@@ -0,0 +1,122 @@
+#include "TextureFile.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+namespace {
+    constexpr std::uint64_t alignBlob(std::uint64_t offset) {
+        return (offset + TextureFile::blob_alignment - 1) / TextureFile::blob_alignment * TextureFile::blob_alignment;
+    }
+
+    std::vector<std::byte> encodeLevel(TextureFile::Format format, const ImageLevel &level) {
+        switch (format) {
+            case TextureFile::Format::Bc1: return encodeBc1(level.pixels, level.size);
+            case TextureFile::Format::Bc3: return encodeBc3(level.pixels, level.size);
+            default: {
+                const auto *bytes = reinterpret_cast<const std::byte*>(level.pixels.data());
+                return { bytes, bytes + level.pixels.size() };
+            }
+        }
+    }
+
+    std::uint64_t getLevelSize(TextureFile::Format format, glm::ivec2 size) {
+        switch (format) {
+            case TextureFile::Format::Bc1: return getBlockCompressedSize(size, 8);
+            case TextureFile::Format::Bc3: return getBlockCompressedSize(size, 16);
+            default: return 4 * std::uint64_t { static_cast<std::uint32_t>(size.x) } * static_cast<std::uint32_t>(size.y);
+        }
+    }
+}
+
+TextureFile::TextureFile(const std::filesystem::path &path) : file { std::in_place, path } {
+    bytes = file->getBytes();
+    validate(path.string());
+}
+
+TextureFile::TextureFile(std::vector<std::byte> bytes) : memory { std::move(bytes) } {
+    this->bytes = memory;
+    validate("Texture data");
+}
+
+std::span<const std::byte> TextureFile::getLevelData(std::uint32_t level) const noexcept {
+    const LevelDescriptor &descriptor = header->levels[level];
+    return bytes.subspan(descriptor.offset, descriptor.size);
+}
+
+GLenum TextureFile::getInternalFormat(Format format) noexcept {
+    switch (format) {
+        case Format::Bc1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case Format::Bc3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        default: return GL_RGBA8;
+    }
+}
+
+std::vector<std::byte> TextureFile::encode(Format format, std::uint64_t source_hash, std::span<const ImageLevel> levels) {
+    if (levels.empty() || levels.size() > max_level_count) {
+        throw std::runtime_error { "Texture file must have 1 to 16 levels" };
+    }
+
+    Header header {};
+    header.magic = magic;
+    header.version = version;
+    header.format = format;
+    header.level_count = static_cast<std::uint32_t>(levels.size());
+    header.source_hash = source_hash;
+
+    std::vector<std::byte> bytes(sizeof(Header));
+    for (std::size_t i = 0; i < levels.size(); ++i) {
+        const std::vector level_data = encodeLevel(format, levels[i]);
+
+        LevelDescriptor &descriptor = header.levels[i];
+        descriptor.width = static_cast<std::uint32_t>(levels[i].size.x);
+        descriptor.height = static_cast<std::uint32_t>(levels[i].size.y);
+        descriptor.offset = alignBlob(bytes.size());
+        descriptor.size = level_data.size();
+
+        bytes.resize(descriptor.offset + descriptor.size);
+        std::memcpy(bytes.data() + descriptor.offset, level_data.data(), level_data.size());
+    }
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    return bytes;
+}
+
+void TextureFile::write(const std::filesystem::path &path, std::span<const std::byte> bytes) {
+    std::ofstream output { path, std::ios::binary };
+    if (!output.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+        throw std::runtime_error { "Failed to write " + path.string() };
+    }
+}
+
+void TextureFile::validate(const std::string &name) {
+    if (bytes.size() < sizeof(Header)) {
+        throw std::runtime_error { name + " is not a texture file" };
+    }
+
+    header = reinterpret_cast<const Header*>(bytes.data());
+    if (header->magic != magic) {
+        throw std::runtime_error { name + " is not a texture file" };
+    }
+    if (header->version != version) {
+        throw std::runtime_error { name + " has unsupported version" };
+    }
+
+    if (header->format > Format::Bc3 || header->level_count == 0 || header->level_count > max_level_count) {
+        throw std::runtime_error { name + " is corrupted" };
+    }
+    for (const LevelDescriptor &level : std::span { header->levels }.first(header->level_count)) {
+        const glm::ivec2 size { static_cast<int>(level.width), static_cast<int>(level.height) };
+        if (level.offset % blob_alignment != 0 || level.size != getLevelSize(header->format, size)
+            || level.offset + level.size > bytes.size()) {
+            throw std::runtime_error { name + " is corrupted" };
+        }
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <GL/gl3w.h>
+
+#include "MappedFile.hpp"
+#include "TextureEncoder.hpp"
+
+/**
+ * GPU-ready texture container (similar to KTX2), whose mip levels are stored in the final format, so it can be uploaded
+ * without decoding or mipmap generation.
+ *
+ * Layout (little endian):
+ * - \p Header, which describes the format and the location of each level.
+ * - Level blobs from the base level to 1x1, each 16-byte aligned.
+ *
+ * Since the file is memory mapped, the level spans point to the mapped pages and can be passed to
+ * \p glCompressedTexImage2D directly. Files are created by \p TextureCache, which keeps the encoded bytes in memory
+ * instead if the file cannot be written.
+ */
+class TextureFile {
+public:
+    static constexpr std::array<char, 4> magic { 'M', 'P', 'T', 'F' };
+    static constexpr std::uint32_t version = 1;
+    static constexpr std::size_t blob_alignment = 16;
+    static constexpr std::size_t max_level_count = 16;
+
+    enum class Format : std::uint32_t {
+        Rgba8, // Uncompressed, for the contexts without S3TC.
+        Bc1,   // DXT1 without alpha, 4 bits per pixel.
+        Bc3,   // DXT5, 8 bits per pixel.
+    };
+
+    struct LevelDescriptor {
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint64_t offset;
+        std::uint64_t size;
+    };
+
+    struct Header {
+        std::array<char, 4> magic;
+        std::uint32_t version;
+        Format format;
+        std::uint32_t level_count;
+        std::uint64_t source_hash; // Hash of the source image file, for detecting stale file.
+        std::uint64_t reserved;
+        std::array<LevelDescriptor, max_level_count> levels;
+    };
+    static_assert(sizeof(Header) % blob_alignment == 0);
+
+    /**
+     * @brief Map and validate the texture file.
+     * @param path Path of the file.
+     * @throw std::runtime_error If the file cannot be mapped or it is not a valid texture file.
+     */
+    explicit TextureFile(const std::filesystem::path &path);
+
+    /**
+     * @brief Validate the texture file content in memory.
+     * @param bytes Texture file content, e.g. the result of \p encode().
+     * @throw std::runtime_error If it is not a valid texture file.
+     */
+    explicit TextureFile(std::vector<std::byte> bytes);
+
+    [[nodiscard]] const Header &getHeader() const noexcept {
+        return *header;
+    }
+
+    /**
+     * @brief Get the data of the mip level in the mapped memory.
+     * @param level Mip level, less than \p getHeader().level_count.
+     */
+    [[nodiscard]] std::span<const std::byte> getLevelData(std::uint32_t level) const noexcept;
+
+    /**
+     * @brief Get the internal format of \p format, which can be passed to \p glTexImage2D or \p glCompressedTexImage2D.
+     */
+    [[nodiscard]] static GLenum getInternalFormat(Format format) noexcept;
+
+    /**
+     * @brief Encode the levels into texture file content.
+     * @param format Format of the stored levels.
+     * @param source_hash Hash of the source image file.
+     * @param levels Mip levels in RGBA8, from the base level.
+     * @throw std::runtime_error If there are too many levels.
+     */
+    [[nodiscard]] static std::vector<std::byte> encode(Format format, std::uint64_t source_hash, std::span<const ImageLevel> levels);
+
+    /**
+     * @brief Write the encoded texture file content.
+     * @param path Path of the file.
+     * @param bytes Result of \p encode().
+     * @throw std::runtime_error If the file cannot be written.
+     */
+    static void write(const std::filesystem::path &path, std::span<const std::byte> bytes);
+
+private:
+    // Either is used. Neither the mapped address nor the vector storage is changed by move, so bytes remains valid.
+    std::optional<MappedFile> file;
+    std::vector<std::byte> memory;
+    std::span<const std::byte> bytes;
+    const Header *header;
+
+    void validate(const std::string &name);
+};
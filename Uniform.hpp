@@ -0,0 +1,105 @@
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+
+#include <GL/gl3w.h>
+
+#include <glm/ext/matrix_float3x3.hpp>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <OGLWrapper/Program.hpp>
+
+/**
+ * Uniform location resolved once at construction.
+ *
+ * Every uniform location query of the process is counted, so that any lookup in the render loop can be found from
+ * \p getNumLookups(). The counter is installed in front of the \p glGetUniformLocation function pointer loaded by gl3w,
+ * therefore it sees the direct calls and the ones made by OGLWrapper as well as the lookups of this class.
+ */
+class UniformLocation {
+public:
+    /**
+     * @brief Total number of uniform location queries made so far (since the first \p UniformLocation was constructed).
+     * It should not increase once the programs are set up.
+     */
+    [[nodiscard]] static std::uint64_t getNumLookups() noexcept {
+        return num_lookups;
+    }
+
+    [[nodiscard]] GLint getLocation() const noexcept {
+        return location;
+    }
+
+protected:
+    GLint location = -1;
+
+    UniformLocation() = default;
+    UniformLocation(const OGLWrapper::Program &program, const char *name) {
+        installLookupCounter();
+        location = program.getUniformLocation(name);
+    }
+
+private:
+    inline static std::uint64_t num_lookups = 0;
+    inline static PFNGLGETUNIFORMLOCATIONPROC driver_get_uniform_location = nullptr;
+
+    static GLint APIENTRY getUniformLocationCounted(GLuint program, const GLchar *name) {
+        ++num_lookups;
+        return driver_get_uniform_location(program, name);
+    }
+
+    // Checked at every construction rather than once, because gl3w reloads the function pointers when it is initialized
+    // again (e.g. for another context).
+    static void installLookupCounter() noexcept {
+        if (glGetUniformLocation != &getUniformLocationCounted) {
+            driver_get_uniform_location = glGetUniformLocation;
+            glGetUniformLocation = &getUniformLocationCounted;
+        }
+    }
+};
+
+/**
+ * Typed uniform handle.
+ *
+ * @code
+ * const Uniform<glm::mat4> model { program, "model" }; // Looked up once.
+ * program.use();
+ * model.set(instance.model); // No string lookup.
+ * @endcode
+ *
+ * @tparam T Type of the uniform value.
+ * @note Like \p glUniform*, \p set() modifies the currently used program.
+ */
+template <typename T>
+class Uniform : public UniformLocation {
+public:
+    Uniform() = default;
+    Uniform(const OGLWrapper::Program &program, const char *name) : UniformLocation { program, name } { }
+
+    void set(const T &value) const {
+        if constexpr (std::same_as<T, glm::mat4>) {
+            glUniformMatrix4fv(location, 1, GL_FALSE, value_ptr(value));
+        }
+        else if constexpr (std::same_as<T, glm::mat3>) {
+            glUniformMatrix3fv(location, 1, GL_FALSE, value_ptr(value));
+        }
+        else if constexpr (std::same_as<T, glm::vec3>) {
+            glUniform3fv(location, 1, value_ptr(value));
+        }
+        else if constexpr (std::same_as<T, float>) {
+            glUniform1f(location, value);
+        }
+        else if constexpr (std::same_as<T, GLint>) {
+            glUniform1i(location, value);
+        }
+        else if constexpr (std::same_as<T, GLuint>) {
+            glUniform1ui(location, value);
+        }
+        else {
+            static_assert(sizeof(T) == 0, "Unsupported uniform type");
+        }
+    }
+};
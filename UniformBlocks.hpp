@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+
+#include <GL/gl3w.h>
+
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float3.hpp>
+
+// std140 layout counterparts of the uniform blocks in the shaders. vec3 is 16-byte aligned in std140.
+
+struct VpMatrix {
+    static constexpr const char *block_name = "VpMatrix";
+    static constexpr GLuint binding = 0;
+
+    alignas(16) glm::mat4 projection_view;
+    alignas(16) glm::vec3 view_pos;
+};
+static_assert(offsetof(VpMatrix, view_pos) == 64);
+
+struct DirectionalLight {
+    static constexpr const char *block_name = "DirectionalLight";
+    static constexpr GLuint binding = 1;
+
+    alignas(16) glm::vec3 direction;
+    alignas(16) glm::vec3 ambient;
+    alignas(16) glm::vec3 diffuse;
+    alignas(16) glm::vec3 specular;
+};
+static_assert(offsetof(DirectionalLight, specular) == 48);
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <concepts>
+#include <type_traits>
+
+#include <GL/gl3w.h>
+
+#include <OGLWrapper/Program.hpp>
+
+/**
+ * Uniform block type, which is a std140 layout compatible struct with its GLSL block name and fixed binding point.
+ */
+template <typename T>
+concept UniformBlock = std::is_trivially_copyable_v<T> && requires {
+    { T::block_name } -> std::convertible_to<const char*>;
+    { T::binding } -> std::convertible_to<GLuint>;
+};
+
+/**
+ * Uniform buffer object which holds a single \p Block, and is bound to <tt>Block::binding</tt> for its lifetime.
+ *
+ * Every program which declares the block shares the buffer, therefore a value is uploaded once regardless of the number
+ * of programs, without any uniform location lookup.
+ *
+ * @code
+ * UniformBuffer<VpMatrix> vp_matrix_buffer;
+ * UniformBuffer<VpMatrix>::bindBlock(program); // Once per program.
+ * vp_matrix_buffer.update({ projection_view, view_pos });
+ * @endcode
+ */
+template <UniformBlock Block>
+class UniformBuffer {
+    GLuint buffer;
+
+public:
+    explicit UniformBuffer(const Block &value = {}) {
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(Block), &value, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+        glBindBufferBase(GL_UNIFORM_BUFFER, Block::binding, buffer);
+    }
+
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer &operator=(const UniformBuffer&) = delete;
+
+    ~UniformBuffer() {
+        glDeleteBuffers(1, &buffer);
+    }
+
+    void update(const Block &value) const {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Block), &value);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    /**
+     * @brief Associate the block of \p program with <tt>Block::binding</tt>.
+     * @note GLSL 3.30 doesn't have the \p binding layout qualifier, so it must be done once for each program. It does
+     * nothing if the program doesn't use the block.
+     */
+    static void bindBlock(const OGLWrapper::Program &program) {
+        if (const GLuint block_index = glGetUniformBlockIndex(program.handle, Block::block_name); block_index != GL_INVALID_INDEX) {
+            glUniformBlockBinding(program.handle, block_index, Block::binding);
+        }
+    }
+};
@@ -0,0 +1,110 @@
+#include "HeadlessContext.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <EGL/eglext.h>
+
+namespace {
+    EGLDisplay getDisplay() {
+        // Prefer the surfaceless platform, which doesn't need any display server. Otherwise, fall back to the default
+        // display (which may also work without a display server, depending on the driver).
+        const char *client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        if (client_extensions && std::strstr(client_extensions, "EGL_MESA_platform_surfaceless")) {
+            const auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+            if (get_platform_display) {
+                if (EGLDisplay display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr); display != EGL_NO_DISPLAY) {
+                    return display;
+                }
+            }
+        }
+        return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+}
+
+void HeadlessContext::allocateStorages() {
+    glBindRenderbuffer(GL_RENDERBUFFER, color_renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, size.x, size.y);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_stencil_renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, size.x, size.y);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+}
+
+HeadlessContext::HeadlessContext(glm::ivec2 size) : size { size } {
+    display = getDisplay();
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+        throw std::runtime_error { "Failed to initialize EGL display" };
+    }
+
+    // Rendering is done into the framebuffer object, therefore no surface is needed.
+    const char *display_extensions = eglQueryString(display, EGL_EXTENSIONS);
+    if (!display_extensions || !std::strstr(display_extensions, "EGL_KHR_surfaceless_context")) {
+        eglTerminate(display);
+        throw std::runtime_error { "EGL_KHR_surfaceless_context is not supported" };
+    }
+
+    // Default EGL_SURFACE_TYPE is EGL_WINDOW_BIT, which surfaceless platform doesn't have.
+    constexpr EGLint config_attributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE,
+    };
+    EGLConfig config;
+    EGLint num_configs;
+    if (!eglBindAPI(EGL_OPENGL_API) || !eglChooseConfig(display, config_attributes, &config, 1, &num_configs) || num_configs == 0) {
+        eglTerminate(display);
+        throw std::runtime_error { "No EGL config supports desktop OpenGL" };
+    }
+
+    constexpr EGLint context_attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE,
+    };
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attributes);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        eglTerminate(display);
+        throw std::runtime_error { "Failed to create OpenGL 3.3 core context" };
+    }
+
+    // With GLVND, function pointers resolved by gl3w dispatch to the current context regardless of it is GLX or EGL.
+    if (gl3wInit() != 0 || !gl3wIsSupported(3, 3)) {
+        eglDestroyContext(display, context);
+        eglTerminate(display);
+        throw std::runtime_error { "Failed to load OpenGL 3.3 functions" };
+    }
+
+    glGenFramebuffers(1, &framebuffer);
+    glGenRenderbuffers(1, &color_renderbuffer);
+    glGenRenderbuffers(1, &depth_stencil_renderbuffer);
+    allocateStorages();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_renderbuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth_stencil_renderbuffer);
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glViewport(0, 0, size.x, size.y);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        throw std::runtime_error { "Offscreen framebuffer is incomplete" };
+    }
+}
+
+HeadlessContext::~HeadlessContext() {
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &color_renderbuffer);
+    glDeleteRenderbuffers(1, &depth_stencil_renderbuffer);
+
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display, context);
+    eglTerminate(display);
+}
+
+void HeadlessContext::resize(glm::ivec2 new_size) {
+    if (new_size != size) {
+        size = new_size;
+        allocateStorages();
+        glViewport(0, 0, size.x, size.y);
+    }
+}
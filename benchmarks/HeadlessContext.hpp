@@ -0,0 +1,45 @@
+#pragma once
+
+#include <EGL/egl.h>
+#include <GL/gl3w.h>
+
+#include <glm/ext/vector_int2.hpp>
+
+/**
+ * OpenGL 3.3 core context without any window, created by surfaceless EGL (e.g. Mesa llvmpipe on a headless node), and
+ * an offscreen framebuffer which plays the role of the default framebuffer of a window.
+ *
+ * The context is made current and OpenGL functions are loaded in the constructor.
+ */
+class HeadlessContext {
+    EGLDisplay display;
+    EGLContext context;
+
+    GLuint framebuffer;
+    GLuint color_renderbuffer;
+    GLuint depth_stencil_renderbuffer;
+    glm::ivec2 size;
+
+    void allocateStorages();
+
+public:
+    /**
+     * @param size Size of the offscreen framebuffer.
+     * @throw std::runtime_error If EGL or OpenGL 3.3 core context is not available.
+     */
+    explicit HeadlessContext(glm::ivec2 size);
+    ~HeadlessContext();
+
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext &operator=(const HeadlessContext&) = delete;
+
+    [[nodiscard]] GLuint getFramebuffer() const noexcept {
+        return framebuffer;
+    }
+
+    [[nodiscard]] glm::ivec2 getSize() const noexcept {
+        return size;
+    }
+
+    void resize(glm::ivec2 new_size);
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <fmt/format.h>
+
+/**
+ * @brief Escape \p str to be written between the quotes of a JSON string.
+ * @param str UTF-8 string, e.g. the renderer name reported by the driver.
+ * @return String whose quotes, backslashes and control characters are escaped.
+ */
+[[nodiscard]] inline std::string escapeJson(std::string_view str) {
+    std::string result;
+    result.reserve(str.size());
+    for (char c : str) {
+        switch (c) {
+            case '"': result += R"(\")"; break;
+            case '\\': result += R"(\\)"; break;
+            case '\n': result += R"(\n)"; break;
+            case '\r': result += R"(\r)"; break;
+            case '\t': result += R"(\t)"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    result += fmt::format(R"(\u{:04x})", static_cast<unsigned char>(c));
+                }
+                else {
+                    result += c;
+                }
+        }
+    }
+    return result;
+}
@@ -0,0 +1,159 @@
+// Replays an input log recorded by the application ("Record input" in the inspector) into an offscreen scene through a
+// surfaceless EGL context. Frame time of each frame and the picked object of each frame are written as JSON, and the
+// picked objects are compared with the recorded ones, so that both performance regressions and picking regressions of
+// the same input can be bisected.
+//
+// Usage: input_replay <log> [--output path]
+// Must be run in the directory where shaders and assets are copied (i.e. build directory).
+// Exits with 2 if any picked object differs from the recording.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+#include <fmt/ranges.h>
+
+#include "HeadlessContext.hpp"
+#include "JsonEscape.hpp"
+#include "InputLog.hpp"
+#include "Scene.hpp"
+
+namespace {
+    struct FrameResult {
+        float frame_ms;          // Of the replay, including the GPU time.
+        float recorded_ms;       // Between the recorded frame ends.
+        std::uint32_t hovered_index;
+        std::uint32_t recorded_hovered_index;
+    };
+
+    glm::ivec2 getInitialSize(const InputLog &log) {
+        for (const InputLog::Event &event : log.getEvents()) {
+            if (const auto *resize = std::get_if<InputLog::Resize>(&event)) {
+                return resize->framebuffer_size;
+            }
+        }
+        return { 640, 640 };
+    }
+
+    std::vector<FrameResult> replay(HeadlessContext &context, Scene &scene, const InputLog &log) {
+        std::vector<FrameResult> results;
+        std::optional<std::chrono::steady_clock::time_point> frame_start;
+        float last_timestamp = 0.f;
+        for (const InputLog::Event &event : log.getEvents()) {
+            if (!frame_start) {
+                frame_start = std::chrono::steady_clock::now();
+            }
+
+            std::visit([&]<typename T>(const T &e) {
+                if constexpr (std::is_same_v<T, InputLog::Resize>) {
+                    context.resize(e.framebuffer_size);
+                    scene.resize(e.framebuffer_size);
+                }
+                else if constexpr (std::is_same_v<T, InputLog::Camera>) {
+                    scene.setCamera(e.view, e.projection);
+                }
+                else if constexpr (std::is_same_v<T, InputLog::Cursor>) {
+                    scene.setCursorPosition(e.on_scene ? std::optional { e.position } : std::nullopt);
+                }
+                else if constexpr (std::is_same_v<T, InputLog::SelectRegion>) {
+                    scene.selectRegion(e.corner1, e.corner2);
+                }
+                else if constexpr (std::is_same_v<T, InputLog::ClearSelection>) {
+                    scene.clearSelection();
+                }
+                else if constexpr (std::is_same_v<T, InputLog::Seed>) {
+                    scene.setRandomSeed(e.random_seed);
+                }
+                else if constexpr (std::is_same_v<T, Scene::Settings>) {
+                    scene.applySettings(e);
+                }
+                else if constexpr (std::is_same_v<T, InputLog::Update>) {
+                    scene.update(e.time_delta);
+                }
+                else if constexpr (std::is_same_v<T, InputLog::EndFrame>) {
+                    scene.draw();
+                    scene.endFrame();
+                    glFinish(); // There is no swap, so wait for the GPU explicitly to include the GPU time.
+
+                    results.push_back({
+                        .frame_ms = std::chrono::duration<float, std::milli> { std::chrono::steady_clock::now() - *frame_start }.count(),
+                        .recorded_ms = 1e3f * (e.timestamp - last_timestamp),
+                        .hovered_index = scene.getHoveredIndex(),
+                        .recorded_hovered_index = e.hovered_index,
+                    });
+                    last_timestamp = e.timestamp;
+                    frame_start.reset();
+                }
+            }, event);
+        }
+        return results;
+    }
+
+    // Object index in JSON, or null for no object.
+    std::string toJson(std::uint32_t index) {
+        return index == Scene::no_hover_index ? "null" : std::to_string(index);
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2 && !(argc == 4 && std::string_view { argv[2] } == "--output")) {
+        fmt::println(std::cerr, "Usage: {} <log> [--output path]", argv[0]);
+        return 1;
+    }
+    const char *output_path = argc == 4 ? argv[3] : "input_replay.json";
+
+    try {
+        const InputLog log { argv[1] };
+        HeadlessContext context { getInitialSize(log) };
+        Scene scene { context.getSize(), context.getFramebuffer() };
+        scene.waitForAssets(); // Measure with the real textures, not the placeholders.
+
+        const std::vector results = replay(context, scene, log);
+
+        std::vector<std::string> frames;
+        std::vector<std::size_t> mismatched_frames;
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const FrameResult &result = results[i];
+            frames.push_back(fmt::format(R"({{ "frame_ms": {:.4f}, "recorded_ms": {:.4f}, "picked": {}, "recorded_picked": {} }})",
+                                         result.frame_ms, result.recorded_ms, toJson(result.hovered_index), toJson(result.recorded_hovered_index)));
+            if (result.hovered_index != result.recorded_hovered_index) {
+                mismatched_frames.push_back(i);
+            }
+        }
+
+        std::ofstream output { output_path };
+        fmt::print(output, "{{\n  \"renderer\": \"{}\",\n  \"random_seed\": {},\n  \"fixed_time_step\": {},\n  \"mismatched_frames\": [{}],\n  \"picking_cache_hits\": {},\n  \"picking_cache_misses\": {},\n  \"frames\": [\n    {}\n  ]\n}}\n",
+                   escapeJson(reinterpret_cast<const char*>(glGetString(GL_RENDERER))), log.getHeader().random_seed, log.getHeader().fixed_time_step,
+                   fmt::join(mismatched_frames, ", "),
+                   scene.getPickingCacheStatistics().num_hits, scene.getPickingCacheStatistics().num_misses, fmt::join(frames, ",\n    "));
+        if (!output) {
+            throw std::runtime_error { fmt::format("Failed to write {}", output_path) };
+        }
+
+        std::vector<float> frame_ms;
+        for (const FrameResult &result : results) {
+            frame_ms.push_back(result.frame_ms);
+        }
+        std::ranges::sort(frame_ms);
+        fmt::println("Replayed {} frames, median frame time {:.3f} ms, {} picking mismatches",
+                     results.size(), frame_ms.empty() ? 0.f : frame_ms[frame_ms.size() / 2], mismatched_frames.size());
+        if (!mismatched_frames.empty()) {
+            fmt::println(std::cerr, "Picked objects differ from the recording at frames {}", fmt::join(mismatched_frames, ", "));
+            return 2;
+        }
+    }
+    catch (const std::runtime_error &e) {
+        fmt::println(std::cerr, "{}", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,74 @@
+// Compares per-frame instance update of the AoS glm::mat4 loop (glm::rotate and inverse-transpose per instance) with the
+// SoA InstanceStore, for 1k ~ 1M instances.
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/gtc/random.hpp>
+#include <glm/matrix.hpp>
+
+#include "InstanceStore.hpp"
+
+namespace {
+    constexpr float time_delta = 1.f / 60.f;
+
+    template <typename F>
+    double measureMilliseconds(std::size_t num_iterations, F &&f) {
+        f(); // Warm up.
+
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < num_iterations; ++i) {
+            f();
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::milli> { elapsed }.count() / static_cast<double>(num_iterations);
+    }
+}
+
+int main() {
+    fmt::println("{:>10} {:>12} {:>12} {:>8}", "instances", "AoS (ms)", "SoA (ms)", "speedup");
+
+    for (std::size_t num_instances : { 1'000U, 10'000U, 100'000U, 1'000'000U }) {
+        // Fewer iterations for larger counts to keep the total run time reasonable.
+        const std::size_t num_iterations = std::max<std::size_t>(10'000'000 / num_instances, 10);
+
+        std::vector<glm::vec3> positions, rotation_axes;
+        positions.reserve(num_instances);
+        rotation_axes.reserve(num_instances);
+        for (std::size_t i = 0; i < num_instances; ++i) {
+            positions.push_back(glm::linearRand(glm::vec3 { -10.f }, glm::vec3 { 10.f }));
+            rotation_axes.push_back(glm::sphericalRand(1.f));
+        }
+
+        // AoS: same as the rotation loop of AppWindow::update, plus the normal matrix computation of the draw.
+        std::vector<glm::mat4> models;
+        models.reserve(num_instances);
+        for (const glm::vec3 &position : positions) {
+            models.push_back(translate(glm::identity<glm::mat4>(), position));
+        }
+        std::vector<InstanceData> aos_output(num_instances);
+        const double aos_ms = measureMilliseconds(num_iterations, [&]() {
+            for (std::size_t i = 0; i < num_instances; ++i) {
+                models[i] = rotate(models[i], time_delta, rotation_axes[i]);
+                aos_output[i] = { models[i], transpose(inverse(glm::mat3 { models[i] })) };
+            }
+        });
+
+        // SoA.
+        InstanceStore instance_store;
+        instance_store.reserve(num_instances);
+        for (std::size_t i = 0; i < num_instances; ++i) {
+            instance_store.push_back(positions[i], glm::quat { 1.f, 0.f, 0.f, 0.f }, rotation_axes[i]);
+        }
+        std::vector<InstanceData> soa_output(num_instances);
+        const double soa_ms = measureMilliseconds(num_iterations, [&]() {
+            instance_store.update(time_delta, soa_output);
+        });
+
+        fmt::println("{:>10} {:>12.4f} {:>12.4f} {:>7.2f}x", num_instances, aos_ms, soa_ms, aos_ms / soa_ms);
+    }
+}
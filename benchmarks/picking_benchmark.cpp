@@ -0,0 +1,314 @@
+// Renders the scene offscreen through a surfaceless EGL context and measures frame time, CPU update time and picking
+// latency over scene layouts (up to a million objects), resolutions, rendering modes and picking modes. Results are
+// written as JSON.
+//
+// Before measuring, objects picked by every rendering mode are compared over a still scene, and the benchmark exits
+// with non-zero status if they differ.
+//
+// Usage: picking_benchmark [--frames N] [--output path]
+// Must be run in the directory where shaders and assets are copied (i.e. build directory).
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+#include <fmt/ostream.h>
+#include <fmt/ranges.h>
+
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+#include "HeadlessContext.hpp"
+#include "JsonEscape.hpp"
+#include "Scene.hpp"
+
+namespace {
+    struct Configuration {
+        SceneLayout scene_layout;
+        glm::ivec2 resolution;
+        Scene::RenderingMode rendering_mode;
+        Scene::PickingMode picking_mode;
+        bool async_readback;
+    };
+
+    struct Percentiles {
+        float p50, p90, p99, max;
+    };
+
+    Percentiles computePercentiles(std::vector<float> samples) {
+        if (samples.empty()) {
+            return {};
+        }
+
+        std::ranges::sort(samples);
+        const auto at = [&](float percentile) {
+            return samples[static_cast<std::size_t>(percentile * static_cast<float>(samples.size() - 1))];
+        };
+        return { at(0.5f), at(0.9f), at(0.99f), samples.back() };
+    }
+
+    std::string toJson(const Percentiles &percentiles) {
+        return fmt::format(R"({{ "p50": {:.4f}, "p90": {:.4f}, "p99": {:.4f}, "max": {:.4f} }})",
+                           percentiles.p50, percentiles.p90, percentiles.p99, percentiles.max);
+    }
+
+    constexpr std::string_view getName(Scene::RenderingMode mode) {
+        switch (mode) {
+            case Scene::RenderingMode::PerObject: return "per_object";
+            case Scene::RenderingMode::Instanced: return "instanced";
+        }
+        return "";
+    }
+
+    constexpr std::string_view getName(SceneLayout::Distribution distribution) {
+        switch (distribution) {
+            case SceneLayout::Distribution::Grid: return "grid";
+            case SceneLayout::Distribution::Random: return "random";
+            case SceneLayout::Distribution::Clustered: return "clustered";
+        }
+        return "";
+    }
+
+    constexpr std::string_view getName(Scene::PickingMode mode) {
+        switch (mode) {
+            case Scene::PickingMode::Stencil: return "stencil";
+            case Scene::PickingMode::ObjectId: return "object_id";
+            case Scene::PickingMode::CpuRayCast: return "cpu_ray_cast";
+        }
+        return "";
+    }
+
+    std::vector<Configuration> getConfigurations() {
+        std::vector<Configuration> configurations;
+        // Grids of the cube counts, a million objects, and hierarchies whose children move every frame.
+        const SceneLayout scene_layouts[] = {
+            { .num_in_side = 6 },
+            { .num_in_side = 16 },
+            { .num_in_side = 32 },
+            { .num_in_side = 64 },
+            { .num_in_side = 100 },
+            { .distribution = SceneLayout::Distribution::Clustered, .num_in_side = 32, .hierarchy_depth = 2, .num_children = 4 },
+        };
+        for (const SceneLayout &scene_layout : scene_layouts) {
+            for (glm::ivec2 resolution : { glm::ivec2 { 640, 640 }, glm::ivec2 { 1280, 720 }, glm::ivec2 { 1920, 1080 } }) {
+                for (Scene::RenderingMode rendering_mode : { Scene::RenderingMode::PerObject, Scene::RenderingMode::Instanced }) {
+                    // A draw call per cube doesn't finish in reasonable time for large counts.
+                    if (rendering_mode == Scene::RenderingMode::PerObject && scene_layout.getNumObjects() > 16 * 16 * 16) {
+                        continue;
+                    }
+
+                    for (Scene::PickingMode picking_mode : { Scene::PickingMode::Stencil, Scene::PickingMode::ObjectId, Scene::PickingMode::CpuRayCast }) {
+                        // Stencil reference value cannot vary per instance (Scene falls back to object ID picking).
+                        if (rendering_mode == Scene::RenderingMode::Instanced && picking_mode == Scene::PickingMode::Stencil) {
+                            continue;
+                        }
+                        configurations.push_back({ scene_layout, resolution, rendering_mode, picking_mode, false });
+                        if (picking_mode != Scene::PickingMode::CpuRayCast) {
+                            configurations.push_back({ scene_layout, resolution, rendering_mode, picking_mode, true });
+                        }
+                    }
+                }
+            }
+        }
+        return configurations;
+    }
+
+    // Camera outside the layout, so that every object is in the view frustum. Children extend it by the spacing per level.
+    void lookAtLayout(Scene &scene, const SceneLayout &scene_layout, glm::ivec2 resolution) {
+        const float scene_extent = scene_layout.spacing * static_cast<float>(scene_layout.num_in_side + 2 * scene_layout.hierarchy_depth);
+        const float camera_distance = std::max(10.f, 2.f * scene_extent);
+        scene.setCamera(
+            lookAt(camera_distance * normalize(glm::vec3 { 1.f }), glm::vec3 { 0.f }, glm::vec3 { 0.f, 1.f, 0.f }),
+            glm::perspective(glm::radians(45.f), static_cast<float>(resolution.x) / static_cast<float>(resolution.y), 1e-2f, 4.f * camera_distance));
+    }
+
+    // Draw a frame without animation, and pick at each position synchronously.
+    std::vector<std::uint32_t> pick(Scene &scene, Scene::RenderingMode rendering_mode, Scene::PickingMode picking_mode, std::span<const glm::ivec2> positions) {
+        scene.setRenderingMode(rendering_mode);
+        scene.setPickingMode(picking_mode);
+        scene.setAsyncReadback(false);
+
+        // No hovered object, so that the outline is not drawn.
+        scene.setCursorPosition(std::nullopt);
+        scene.update(0.f);
+        scene.draw();
+        scene.endFrame();
+
+        std::vector<std::uint32_t> hovered_indices;
+        for (glm::ivec2 position : positions) {
+            scene.setCursorPosition(position);
+            hovered_indices.push_back(scene.getHoveredIndex());
+        }
+        return hovered_indices;
+    }
+
+    // Compare the objects picked from the object ID buffer of each rendering mode with the ones of the per object stencil
+    // picking, which is the reference. Layout must have less than 255 objects, so that stencil distinguishes every object.
+    // Returns the number of mismatched positions.
+    std::size_t checkPicking(HeadlessContext &context, Scene &scene, const SceneLayout &scene_layout) {
+        constexpr glm::ivec2 resolution { 640, 640 };
+        constexpr int sample_stride = 4;
+
+        context.resize(resolution);
+        scene.resize(resolution);
+        scene.setSceneLayout(scene_layout);
+        lookAtLayout(scene, scene_layout, resolution);
+        scene.setLodSelection(false);
+        scene.update(0.7f); // Rotate the objects once, so that they are not axis aligned.
+
+        std::vector<glm::ivec2> positions;
+        for (int y = sample_stride / 2; y < resolution.y; y += sample_stride) {
+            for (int x = sample_stride / 2; x < resolution.x; x += sample_stride) {
+                positions.emplace_back(x, y);
+            }
+        }
+
+        const std::vector reference = pick(scene, Scene::RenderingMode::PerObject, Scene::PickingMode::Stencil, positions);
+        std::size_t num_mismatches = 0;
+        for (Scene::RenderingMode rendering_mode : { Scene::RenderingMode::PerObject, Scene::RenderingMode::Instanced }) {
+            const std::vector hovered_indices = pick(scene, rendering_mode, Scene::PickingMode::ObjectId, positions);
+            std::size_t num_mode_mismatches = 0;
+            for (std::size_t i = 0; i < positions.size(); ++i) {
+                num_mode_mismatches += hovered_indices[i] != reference[i];
+            }
+            fmt::println("Picking check ({} objects, {}, object_id): {}/{} mismatches",
+                         scene.getNumInstances(), getName(rendering_mode), num_mode_mismatches, positions.size());
+            num_mismatches += num_mode_mismatches;
+        }
+
+        scene.setLodSelection(true);
+        return num_mismatches;
+    }
+
+    std::string run(HeadlessContext &context, Scene &scene, const Configuration &configuration, int num_frames) {
+        constexpr float time_delta = 1.f / 60.f;
+        constexpr int num_warmup_frames = 10;
+
+        context.resize(configuration.resolution);
+        scene.resize(configuration.resolution);
+        if (scene.getSceneLayout() != configuration.scene_layout) {
+            scene.setSceneLayout(configuration.scene_layout);
+        }
+        scene.setRenderingMode(configuration.rendering_mode);
+        scene.setPickingMode(configuration.picking_mode);
+        scene.setAsyncReadback(configuration.async_readback);
+
+        const SceneLayout &scene_layout = configuration.scene_layout;
+        lookAtLayout(scene, scene_layout, configuration.resolution);
+        const glm::vec2 resolution { configuration.resolution };
+
+        // Statistics of the instance buffer are accumulated over the scene lifetime.
+        const std::uint64_t num_streaming_stalls_before = scene.getInstanceStreamingStatistics().num_stalls;
+
+        // Asynchronous picking latency is sampled once per consumed readback, from its request to its consume.
+        std::uint64_t num_consumed_readbacks = scene.getReadbackStatistics().num_consumed;
+
+        std::vector<float> frame_ms, update_ms, pick_ms;
+        for (int frame = 0; frame < num_warmup_frames + num_frames; ++frame) {
+            const auto start = std::chrono::steady_clock::now();
+
+            // Cursor sweeps over the framebuffer along a Lissajous curve, so it hovers both cubes and the background.
+            const float t = static_cast<float>(frame) * time_delta;
+            const glm::vec2 cursor = 0.5f * resolution * (1.f + glm::vec2 { std::sin(1.3f * t), std::sin(1.7f * t) });
+            scene.setCursorPosition(glm::clamp(glm::ivec2 { cursor }, glm::ivec2 { 0 }, configuration.resolution - 1));
+
+            scene.update(time_delta);
+            scene.draw();
+            scene.endFrame();
+            glFinish(); // There is no swap, so wait for the GPU explicitly to include the GPU time.
+
+            if (frame < num_warmup_frames) {
+                continue;
+            }
+            frame_ms.push_back(std::chrono::duration<float, std::milli> { std::chrono::steady_clock::now() - start }.count());
+            update_ms.push_back(scene.getFrameStatistics().update_ms);
+            if (!configuration.async_readback) {
+                pick_ms.push_back(scene.getFrameStatistics().pick_ms);
+            }
+            else if (const PixelReadback::Statistics &statistics = scene.getReadbackStatistics(); statistics.num_consumed != num_consumed_readbacks) {
+                pick_ms.push_back(statistics.latency_ms);
+                num_consumed_readbacks = statistics.num_consumed;
+            }
+        }
+
+        const PixelReadback::Statistics &readback_statistics = scene.getReadbackStatistics();
+        return fmt::format(
+            R"({{ "instances": {}, "distribution": "{}", "hierarchy_depth": {}, "width": {}, "height": {}, "rendering_mode": "{}", "picking_mode": "{}", "async_readback": {}, "frames": {}, )"
+            R"("frame_ms": {}, "update_ms": {}, "pick_ms": {}, "readback_latency_frames": {}, "readback_stalls": {}, )"
+            R"("persistent_streaming": {}, "instance_buffer_stalls": {} }})",
+            scene.getNumInstances(), getName(scene_layout.distribution), scene_layout.hierarchy_depth, configuration.resolution.x, configuration.resolution.y,
+            getName(configuration.rendering_mode), getName(configuration.picking_mode), configuration.async_readback, num_frames,
+            toJson(computePercentiles(frame_ms)), toJson(computePercentiles(update_ms)), toJson(computePercentiles(pick_ms)),
+            configuration.async_readback ? readback_statistics.latency_frames : 0,
+            configuration.async_readback ? readback_statistics.num_stalls : 0,
+            scene.isPersistentStreaming(), scene.getInstanceStreamingStatistics().num_stalls - num_streaming_stalls_before);
+    }
+}
+
+int main(int argc, char **argv) {
+    int num_frames = 120;
+    const char *output_path = "picking_benchmark.json";
+    for (int i = 1; i < argc; i += 2) {
+        const std::string_view option { argv[i] };
+        if (i + 1 < argc && option == "--frames") {
+            num_frames = std::max(std::atoi(argv[i + 1]), 1);
+        }
+        else if (i + 1 < argc && option == "--output") {
+            output_path = argv[i + 1];
+        }
+        else {
+            // Unknown option, or an option without its value.
+            fmt::println(std::cerr, "Usage: {} [--frames N] [--output path]", argv[0]);
+            return 1;
+        }
+    }
+
+    try {
+        HeadlessContext context { { 640, 640 } };
+        Scene scene { context.getSize(), context.getFramebuffer() };
+        scene.waitForAssets(); // Measure with the real textures, not the placeholders.
+
+        fmt::println("Renderer: {}", reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+
+        // A grid and a hierarchy, both below 255 objects.
+        std::size_t num_picking_mismatches = 0;
+        for (const SceneLayout &scene_layout : { SceneLayout { .num_in_side = 6 },
+                                                 SceneLayout { .distribution = SceneLayout::Distribution::Clustered, .num_in_side = 4, .hierarchy_depth = 1, .num_children = 2 } }) {
+            num_picking_mismatches += checkPicking(context, scene, scene_layout);
+        }
+        if (num_picking_mismatches != 0) {
+            fmt::println(std::cerr, "Picked objects differ between the rendering modes at {} positions", num_picking_mismatches);
+            return 1;
+        }
+
+        const std::vector configurations = getConfigurations();
+        std::vector<std::string> results;
+        for (const Configuration &configuration : configurations) {
+            results.push_back(run(context, scene, configuration, num_frames));
+            fmt::println("[{}/{}] {}", results.size(), configurations.size(), results.back());
+        }
+
+        std::ofstream output { output_path };
+        fmt::print(output, "{{\n  \"renderer\": \"{}\",\n  \"results\": [\n    {}\n  ]\n}}\n",
+                   escapeJson(reinterpret_cast<const char*>(glGetString(GL_RENDERER))), fmt::join(results, ",\n    "));
+        if (!output) {
+            throw std::runtime_error { fmt::format("Failed to write {}", output_path) };
+        }
+    }
+    catch (const std::runtime_error &e) {
+        fmt::println(std::cerr, "{}", e.what());
+        return 1;
+    }
+}
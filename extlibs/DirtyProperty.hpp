@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <utility>
 #include <type_traits>
 #include <concepts>
@@ -68,6 +69,7 @@ template <typename T>
 class DirtyProperty{
     bool is_dirty;
     T data;
+    std::uint64_t version = 0; // Increased whenever the property gets dirty, for DerivedProperty.
 
     friend struct DirtyPropertyHelper;
 
@@ -90,6 +92,7 @@ public:
     constexpr DirtyProperty &operator=(auto &&new_value){
         data = DIRTY_PROPERTY_FWD(new_value);
         is_dirty = true;
+        ++version;
         return *this;
     }
 
@@ -129,6 +132,16 @@ public:
      */
     constexpr void makeDirty() noexcept{
         is_dirty = true;
+        ++version;
+    }
+
+    /**
+     * @brief Get the modification count of the property. Unlike dirty flag, it is not reset by \p clean(), so multiple
+     * dependents can track the modification independently.
+     * @return Modification count.
+     */
+    [[nodiscard]] constexpr std::uint64_t getVersion() const noexcept{
+        return version;
     }
 
     /**
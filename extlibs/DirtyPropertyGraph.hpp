@@ -0,0 +1,247 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <tuple>
+#include <vector>
+
+#include "DirtyProperty.hpp"
+
+/**
+ * Lazily evaluated property computed from input properties, which are either \p DirtyProperty or another
+ * \p DerivedProperty. Together they form a dependency graph whose sources are dirty properties.
+ *
+ * The value is recomputed only when it is read and any input has been modified since the last computation. Reading an
+ * input first brings the input itself up to date, so the graph is always evaluated in topological order, and each node
+ * is computed at most once per modification of its inputs no matter how many times it is read. If the recomputed value
+ * is equal to the previous one, dependents are not invalidated (early cutoff).
+ *
+ * @tparam T Type of the computed value.
+ * @tparam Inputs Types of the input properties.
+ *
+ * @code
+ * DirtyProperty<float> fov { 45.f }, aspect { 1.f };
+ * DerivedProperty projection { [](float fov, float aspect){
+ *     return glm::perspective(glm::radians(fov), aspect, 0.1f, 100.f);
+ * }, fov, aspect };
+ *
+ * fov = 60.f;
+ * projection.value(); // Recomputed.
+ * projection.value(); // Not recomputed.
+ *
+ * // It can be cleaned like DirtyProperty, e.g. with DirtyPropertyHelper::clean(f, view, projection).
+ * projection.clean([](const glm::mat4 &projection){
+ *     // Executed once per change of fov or aspect.
+ * });
+ * @endcode
+ *
+ * @note Inputs are referenced, so they must outlive the derived property.
+ */
+template <typename T, typename ...Inputs>
+class DerivedProperty{
+    std::function<T(const typename Inputs::value_type&...)> function;
+    std::tuple<const Inputs&...> inputs;
+
+    // Lazily updated state, which is logically a part of the value.
+    mutable std::optional<T> data;
+    mutable std::array<std::uint64_t, sizeof...(Inputs)> input_versions {};
+    mutable std::uint64_t version = 0;
+    mutable bool is_dirty = true;
+
+    friend struct DirtyPropertyHelper;
+
+    void update() const{
+        const auto current_input_versions = std::apply([](const Inputs &...inputs){
+            return std::array<std::uint64_t, sizeof...(Inputs)> { inputs.getVersion()... };
+        }, inputs);
+        if (data && current_input_versions == input_versions){
+            return;
+        }
+
+        T new_data = std::apply([&](const Inputs &...inputs){
+            return std::invoke(function, inputs.value()...);
+        }, inputs);
+        input_versions = current_input_versions;
+
+        if constexpr (std::equality_comparable<T>){
+            if (data && *data == new_data){
+                return;
+            }
+        }
+        data = std::move(new_data);
+        is_dirty = true;
+        ++version;
+    }
+
+public:
+    using value_type = T;
+
+    template <typename Function> requires std::is_invocable_r_v<T, Function, const typename Inputs::value_type&...>
+    explicit DerivedProperty(Function &&function, const Inputs &...inputs)
+            : function { DIRTY_PROPERTY_FWD(function) }, inputs { inputs... }
+    {
+
+    }
+
+    // Copied property would reference the inputs of the original one.
+    DerivedProperty(const DerivedProperty&) = delete;
+    DerivedProperty &operator=(const DerivedProperty&) = delete;
+
+    /**
+     * @brief Get const reference of the value, which is recomputed if any input is modified.
+     * @return Const reference of the value.
+     */
+    [[nodiscard]] const T &value() const{
+        update();
+        return *data;
+    }
+
+    /**
+     * @brief Get the modification count of the value.
+     * @return Modification count.
+     */
+    [[nodiscard]] std::uint64_t getVersion() const{
+        update();
+        return version;
+    }
+
+    /**
+     * @brief Check whether the value is modified after the last \p clean().
+     * @return \p true if the property is dirty, \p false otherwise.
+     */
+    [[nodiscard]] bool isDirty() const{
+        update();
+        return is_dirty;
+    }
+
+    /**
+     * Execute the given function when the value is modified after the last \p clean(), and set dirty flag to \p false.
+     * @param function Function to execute when the property is dirty.
+     */
+    template <typename UnaryFunction> requires std::invocable<UnaryFunction, const T&>
+    void clean(UnaryFunction &&function){
+        if (isDirty()){
+            std::invoke(DIRTY_PROPERTY_FWD(function), *data);
+            is_dirty = false;
+        }
+    }
+};
+
+template <typename Function, typename ...Inputs>
+DerivedProperty(Function&&, const Inputs&...) -> DerivedProperty<std::invoke_result_t<Function, const typename Inputs::value_type&...>, Inputs...>;
+
+/**
+ * Array of properties with per-element dirty flags, for a large number of derived values (e.g. per-instance world space
+ * bounds derived from model matrices) which should be recomputed incrementally instead of all at once.
+ *
+ * Invalidations are batched: elements are marked dirty individually or by range when their inputs change, and the
+ * dirty ones are recomputed together by \p clean(). Chains are formed by marking the dependent array dirty in the
+ * cleaning function.
+ *
+ * @tparam T Type of the element.
+ *
+ * @code
+ * DirtyPropertyArray<glm::mat3> normal_matrices { num_instances };
+ * DirtyPropertyArray<AABB> world_bounds { num_instances };
+ *
+ * // Models of [first, last) are changed.
+ * normal_matrices.makeDirty(first, last);
+ * normal_matrices.clean([&](std::size_t index, glm::mat3 &normal_matrix){
+ *     normal_matrix = inverseTranspose(glm::mat3 { models[index] });
+ *     world_bounds.makeDirty(index);
+ * });
+ * @endcode
+ *
+ * @note Disjoint ranges can be marked and cleaned concurrently.
+ */
+template <typename T>
+class DirtyPropertyArray{
+    std::vector<T> data;
+    std::vector<std::uint8_t> dirty_flags; // Not std::vector<bool>, so that adjacent elements are not in the same byte.
+
+public:
+    using value_type = T;
+
+    DirtyPropertyArray() = default;
+
+    /**
+     * @brief Construct an array of \p size default constructed elements, all of which are dirty.
+     * @param size Number of the elements.
+     */
+    explicit DirtyPropertyArray(std::size_t size) : data(size), dirty_flags(size, true){
+
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept{
+        return data.size();
+    }
+
+    /**
+     * @brief Resize the array. Every element gets dirty.
+     * @param size New number of the elements.
+     */
+    void resize(std::size_t size){
+        data.resize(size);
+        dirty_flags.assign(size, true);
+    }
+
+    [[nodiscard]] const T &operator[](std::size_t index) const noexcept{
+        return data[index];
+    }
+
+    [[nodiscard]] std::span<const T> values() const noexcept{
+        return data;
+    }
+
+    [[nodiscard]] bool isDirty(std::size_t index) const noexcept{
+        return dirty_flags[index];
+    }
+
+    [[nodiscard]] bool isAnyDirty() const noexcept{
+        return std::ranges::any_of(dirty_flags, [](std::uint8_t flag){ return flag != 0; });
+    }
+
+    void makeDirty(std::size_t index) noexcept{
+        dirty_flags[index] = true;
+    }
+
+    void makeDirty(std::size_t first, std::size_t last) noexcept{
+        assert(first <= last && last <= size());
+        std::fill(dirty_flags.begin() + first, dirty_flags.begin() + last, true);
+    }
+
+    void makeAllDirty() noexcept{
+        std::ranges::fill(dirty_flags, true);
+    }
+
+    /**
+     * Recompute the dirty elements in <tt>[first, last)</tt>, and set their dirty flags to \p false.
+     * @param function Invoked as <tt>function(index, element)</tt> for each dirty element, which must write the new value
+     * to \p element.
+     * @return Number of the recomputed elements.
+     */
+    template <typename Function> requires std::invocable<Function, std::size_t, T&>
+    std::size_t clean(std::size_t first, std::size_t last, Function &&function){
+        assert(first <= last && last <= size());
+        std::size_t num_cleaned = 0;
+        for (std::size_t index = first; index < last; ++index){
+            if (dirty_flags[index]){
+                std::invoke(function, index, data[index]);
+                dirty_flags[index] = false;
+                ++num_cleaned;
+            }
+        }
+        return num_cleaned;
+    }
+
+    template <typename Function> requires std::invocable<Function, std::size_t, T&>
+    std::size_t clean(Function &&function){
+        return clean(0, size(), DIRTY_PROPERTY_FWD(function));
+    }
+};
@@ -5,37 +5,45 @@ in VS_OUT{
     vec3 normal;
     vec2 texCoords;
 } fs_in;
+flat in uint objectId;
+flat in uint materialIndex;
 
-out vec4 FragColor;
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out uint FragObjectId; // Only written when object ID framebuffer is bound.
 
-uniform struct DirectionalLight{
+layout (std140) uniform DirectionalLight{
     vec3 direction;
     vec3 ambient;
     vec3 diffuse;
     vec3 specular;
-} light = DirectionalLight(vec3(-1.0), vec3(0.4), vec3(0.8), vec3(0.5));
+} light;
 
-uniform struct VpMatrix{
-    vec3 view_pos;
+layout (std140) uniform VpMatrix{
     mat4 projection_view;
+    vec3 view_pos;
 } vp_matrix;
 
-uniform sampler2D diffuse_map;
-uniform sampler2D specular_map;
+// Layer of each array is the material index.
+uniform sampler2DArray diffuse_maps;
+uniform sampler2DArray specular_maps;
 
 void main() {
-    vec3 ambient = light.ambient * vec3(texture(diffuse_map, fs_in.texCoords));
+    vec3 texCoords = vec3(fs_in.texCoords, float(materialIndex));
+    vec3 diffuseColor = vec3(texture(diffuse_maps, texCoords));
+
+    vec3 ambient = light.ambient * diffuseColor;
 
     vec3 norm = normalize(fs_in.normal);
     vec3 lightDir = normalize(-light.direction);
     float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = light.diffuse * diff * vec3(texture(diffuse_map, fs_in.texCoords));
+    vec3 diffuse = light.diffuse * diff * diffuseColor;
 
     vec3 viewDir = normalize(vp_matrix.view_pos - fs_in.fragPos);
     vec3 halfwayDir = normalize(lightDir + viewDir);
     float spec = pow(max(dot(norm, halfwayDir), 0.0), 32.0);
-    vec3 specular = light.specular * spec * vec3(texture(specular_map, fs_in.texCoords));
+    vec3 specular = light.specular * spec * vec3(texture(specular_maps, texCoords));
 
     vec3 result = ambient + diffuse + specular;
     FragColor = vec4(result, 1.0);
+    FragObjectId = objectId;
 }
@@ -9,18 +9,24 @@ out VS_OUT{
     vec3 normal;
     vec2 texCoords;
 } vs_out;
+flat out uint objectId;
+flat out uint materialIndex;
 
 uniform mat4 model;
-uniform mat4 inv_model;
+uniform mat3 normal_matrix;
+uniform uint object_id;
+uniform uint material_index;
 
-uniform struct VpMatrix{
-    vec3 view_pos;
+layout (std140) uniform VpMatrix{
     mat4 projection_view;
+    vec3 view_pos;
 } vp_matrix;
 
 void main() {
     vs_out.fragPos = aPos;
     gl_Position = vp_matrix.projection_view * model * vec4(vs_out.fragPos, 1.0);
-    vs_out.normal = mat3(transpose(inv_model)) * aNormal;
+    vs_out.normal = normal_matrix * aNormal;
     vs_out.texCoords = aTexCoords;
+    objectId = object_id;
+    materialIndex = material_index;
 }
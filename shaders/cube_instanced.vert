@@ -0,0 +1,31 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in mat4 aModel; // Per instance, occupies location 3 ~ 6.
+layout (location = 7) in mat3 aNormalMatrix; // Per instance, occupies location 7 ~ 9.
+layout (location = 10) in uint aObjectId; // Per instance.
+layout (location = 11) in uint aMaterialIndex; // Per instance.
+
+out VS_OUT{
+    vec3 fragPos;
+    vec3 normal;
+    vec2 texCoords;
+} vs_out;
+flat out uint objectId;
+flat out uint materialIndex;
+
+layout (std140) uniform VpMatrix{
+    mat4 projection_view;
+    vec3 view_pos;
+} vp_matrix;
+
+void main() {
+    vs_out.fragPos = aPos;
+    gl_Position = vp_matrix.projection_view * aModel * vec4(vs_out.fragPos, 1.0);
+    vs_out.normal = aNormalMatrix * aNormal;
+    vs_out.texCoords = aTexCoords;
+    objectId = aObjectId;
+    materialIndex = aMaterialIndex;
+}
@@ -6,9 +6,9 @@ layout (location = 2) in vec2 aTexCoords;
 
 uniform mat4 model;
 
-uniform struct VpMatrix{
-    vec3 view_pos;
+layout (std140) uniform VpMatrix{
     mat4 projection_view;
+    vec3 view_pos;
 } vp_matrix;
 
 void main() {
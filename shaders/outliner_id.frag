@@ -0,0 +1,16 @@
+#version 330 core
+
+out vec4 FragColor;
+
+uniform vec3 color = vec3(1.0, 0.5, 0.2);
+
+uniform usampler2D object_id_map;
+uniform uint hovered_id;
+
+void main() {
+    // Fragments covered by the hovered object itself are not the outline.
+    if (texelFetch(object_id_map, ivec2(gl_FragCoord.xy), 0).r == hovered_id) {
+        discard;
+    }
+    FragColor = vec4(color, 1.0);
+}
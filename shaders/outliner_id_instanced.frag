@@ -0,0 +1,17 @@
+#version 330 core
+
+flat in uint objectId;
+
+out vec4 FragColor;
+
+uniform vec3 color = vec3(0.2, 0.6, 1.0);
+
+uniform usampler2D object_id_map;
+
+void main() {
+    // Fragments covered by the object itself are not the outline.
+    if (texelFetch(object_id_map, ivec2(gl_FragCoord.xy), 0).r == objectId) {
+        discard;
+    }
+    FragColor = vec4(color, 1.0);
+}
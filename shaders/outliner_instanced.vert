@@ -0,0 +1,21 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in mat4 aModel; // Per instance, occupies location 3 ~ 6.
+layout (location = 10) in uint aObjectId; // Per instance.
+
+flat out uint objectId;
+
+uniform float scale_factor = 1.05;
+
+layout (std140) uniform VpMatrix{
+    mat4 projection_view;
+    vec3 view_pos;
+} vp_matrix;
+
+void main() {
+    gl_Position = vp_matrix.projection_view * aModel * vec4(scale_factor * aPos, 1.0);
+    objectId = aObjectId;
+}
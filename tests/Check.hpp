@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+#include <source_location>
+#include <string_view>
+
+/**
+ * Minimal assertion helpers for the test executables. A failed check is reported with its location and counted, and
+ * the test continues, so that every failure of the run is reported. Return \p check::exitCode() from \p main.
+ *
+ * @code
+ * CHECK(bvh.getNodes().size() == 1);
+ * CHECK_EQ(hit->primitive_index, 2U);
+ * return check::exitCode();
+ * @endcode
+ */
+namespace check {
+    inline int num_failures = 0;
+
+    inline void fail(std::string_view expression, const std::source_location &location) {
+        std::cerr << location.file_name() << ':' << location.line() << ": check failed: " << expression << '\n';
+        ++num_failures;
+    }
+
+    [[nodiscard]] inline int exitCode() noexcept {
+        if (num_failures != 0) {
+            std::cerr << num_failures << " check(s) failed\n";
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+}
+
+// Variadic, so that the expression may contain braced initializers with commas.
+#define CHECK(...) \
+    do { \
+        if (!(__VA_ARGS__)) { \
+            check::fail(#__VA_ARGS__, std::source_location::current()); \
+        } \
+    } while (false)
+
+#define CHECK_EQ(lhs, rhs) \
+    do { \
+        if (!((lhs) == (rhs))) { \
+            check::fail(#lhs " == " #rhs, std::source_location::current()); \
+            std::cerr << "  " #lhs " = " << (lhs) << ", " #rhs " = " << (rhs) << '\n'; \
+        } \
+    } while (false)
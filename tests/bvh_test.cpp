@@ -0,0 +1,163 @@
+// CPU-only tests of the ray cast picking: Möller–Trumbore ray/triangle and slab ray/AABB tests, and the closest hit
+// query of the BVH (compared with the brute force search) before and after refit.
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "Bvh.hpp"
+#include "Check.hpp"
+
+namespace {
+    void testTriangleIntersection() {
+        constexpr glm::vec3 v0 { -1.f, -1.f, 0.f }, v1 { 1.f, -1.f, 0.f }, v2 { 0.f, 1.f, 0.f };
+        constexpr float t_max = 100.f;
+
+        // Hit at the center, from both sides.
+        const auto front = Ray { { 0.f, 0.f, 2.f }, { 0.f, 0.f, -1.f } }.intersect(v0, v1, v2, t_max);
+        CHECK(front && std::abs(*front - 2.f) < 1e-5f);
+        const auto back = Ray { { 0.f, 0.f, -3.f }, { 0.f, 0.f, 2.f } }.intersect(v0, v1, v2, t_max);
+        CHECK(back && std::abs(*back - 1.5f) < 1e-5f);
+
+        // Outside of the triangle, but inside of its bounding box.
+        CHECK(!Ray { { 0.9f, 0.9f, 2.f }, { 0.f, 0.f, -1.f } }.intersect(v0, v1, v2, t_max));
+
+        // Parallel to the plane of the triangle.
+        CHECK(!Ray { { 0.f, 0.f, 2.f }, { 1.f, 0.f, 0.f } }.intersect(v0, v1, v2, t_max));
+
+        // Triangle behind the origin.
+        CHECK(!Ray { { 0.f, 0.f, 2.f }, { 0.f, 0.f, 1.f } }.intersect(v0, v1, v2, t_max));
+
+        // Triangle farther than t_max.
+        CHECK(!Ray { { 0.f, 0.f, 2.f }, { 0.f, 0.f, -1.f } }.intersect(v0, v1, v2, 1.f));
+    }
+
+    void testAabbIntersection() {
+        const AABB aabb { glm::vec3 { -1.f }, glm::vec3 { 1.f } };
+        constexpr float t_max = 100.f;
+
+        const Ray ray { { -3.f, 0.f, 0.f }, { 1.f, 0.f, 0.f } };
+        const auto hit = ray.intersect(1.f / ray.direction, aabb, t_max);
+        CHECK(hit && std::abs(*hit - 2.f) < 1e-5f);
+
+        // Ray starting inside of the box enters at 0.
+        const Ray inside { glm::vec3 { 0.f }, { 0.f, 1.f, 0.f } };
+        const auto inside_hit = inside.intersect(1.f / inside.direction, aabb, t_max);
+        CHECK(inside_hit && *inside_hit == 0.f);
+
+        const Ray miss { { -3.f, 2.f, 0.f }, { 1.f, 0.f, 0.f } };
+        CHECK(!miss.intersect(1.f / miss.direction, aabb, t_max));
+
+        const Ray away { { -3.f, 0.f, 0.f }, { -1.f, 0.f, 0.f } };
+        CHECK(!away.intersect(1.f / away.direction, aabb, t_max));
+    }
+
+    std::optional<Bvh::Hit> closestHitBruteForce(std::span<const AABB> bounds, const Ray &ray) {
+        const glm::vec3 inv_direction = 1.f / ray.direction;
+        std::optional<Bvh::Hit> closest;
+        for (std::uint32_t i = 0; i < bounds.size(); ++i) {
+            if (auto t = ray.intersect(inv_direction, bounds[i], closest ? closest->distance : std::numeric_limits<float>::max());
+                t && (!closest || *t < closest->distance)) {
+                closest = Bvh::Hit { i, *t };
+            }
+        }
+        return closest;
+    }
+
+    std::optional<Bvh::Hit> closestHit(const Bvh &bvh, std::span<const AABB> bounds, const Ray &ray) {
+        const glm::vec3 inv_direction = 1.f / ray.direction;
+        return bvh.closestHit(ray, [&](std::uint32_t primitive_index, float t_max) {
+            return ray.intersect(inv_direction, bounds[primitive_index], t_max);
+        });
+    }
+
+    void testEmptyBvh() {
+        const Bvh bvh;
+        CHECK(!bvh.closestHit(Ray { glm::vec3 { 0.f }, { 1.f, 0.f, 0.f } }, [](std::uint32_t, float) -> std::optional<float> {
+            return 0.f;
+        }));
+    }
+
+    void testOverlappingPrimitives() {
+        // Nested boxes around the origin and a box behind them: the ray from +x hits the outermost box first.
+        const std::vector<AABB> bounds {
+            { glm::vec3 { -1.f }, glm::vec3 { 1.f } },
+            { glm::vec3 { -3.f }, glm::vec3 { 3.f } },
+            { glm::vec3 { -2.f }, glm::vec3 { 2.f } },
+            { { -10.f, -1.f, -1.f }, { -8.f, 1.f, 1.f } },
+        };
+        const Bvh bvh { bounds };
+
+        const auto hit = closestHit(bvh, bounds, Ray { { 10.f, 0.f, 0.f }, { -1.f, 0.f, 0.f } });
+        CHECK(hit);
+        if (hit) {
+            CHECK_EQ(hit->primitive_index, 1U);
+            CHECK(std::abs(hit->distance - 7.f) < 1e-5f);
+        }
+
+        // From the other side, the box behind the others is hit first.
+        const auto back_hit = closestHit(bvh, bounds, Ray { { -20.f, 0.f, 0.f }, { 1.f, 0.f, 0.f } });
+        CHECK(back_hit && back_hit->primitive_index == 3U);
+
+        // Miss.
+        CHECK(!closestHit(bvh, bounds, Ray { { 10.f, 5.f, 0.f }, { -1.f, 0.f, 0.f } }));
+    }
+
+    void testRandomRays() {
+        std::mt19937 random { 42 };
+        std::uniform_real_distribution position_distribution { -20.f, 20.f };
+        std::uniform_real_distribution size_distribution { 0.1f, 2.f };
+        const auto random_vec3 = [&](auto &distribution) {
+            return glm::vec3 { distribution(random), distribution(random), distribution(random) };
+        };
+
+        // More primitives than a leaf, so that the tree has several levels.
+        std::vector<AABB> bounds(500);
+        for (AABB &aabb : bounds) {
+            const glm::vec3 center = random_vec3(position_distribution);
+            const glm::vec3 half_extent = random_vec3(size_distribution);
+            aabb = { center - half_extent, center + half_extent };
+        }
+        Bvh bvh { bounds };
+        CHECK(bvh.getNodes().size() > 1);
+
+        const auto check_rays = [&]() {
+            for (int i = 0; i < 1000; ++i) {
+                // Rays from outside of the volume toward a random point inside of it.
+                const glm::vec3 origin = 3.f * random_vec3(position_distribution);
+                const Ray ray { origin, random_vec3(position_distribution) - origin };
+
+                const auto expected = closestHitBruteForce(bounds, ray);
+                const auto hit = closestHit(bvh, bounds, ray);
+                CHECK_EQ(hit.has_value(), expected.has_value());
+                if (hit && expected) {
+                    // Ties (e.g. a shared face) may resolve to either primitive, but the distance must be the same.
+                    CHECK(hit->distance == expected->distance);
+                }
+            }
+        };
+        check_rays();
+
+        // Move every primitive and refit.
+        for (AABB &aabb : bounds) {
+            const glm::vec3 offset = 0.2f * random_vec3(position_distribution);
+            aabb.min += offset;
+            aabb.max += offset;
+        }
+        bvh.refit(bounds);
+        check_rays();
+    }
+}
+
+int main() {
+    testTriangleIntersection();
+    testAabbIntersection();
+    testEmptyBvh();
+    testOverlappingPrimitives();
+    testRandomRays();
+    return check::exitCode();
+}
@@ -0,0 +1,131 @@
+// Tests of the lazily evaluated properties: DerivedProperty recomputes only when an input changed (through a chain of
+// derived properties, with early cutoff), and DirtyPropertyArray recomputes only the dirty elements and clears them.
+
+#include <cstddef>
+#include <vector>
+
+#include <DirtyPropertyGraph.hpp>
+
+#include "Check.hpp"
+
+namespace {
+    void testDerivedProperty() {
+        DirtyProperty<int> a { 1 }, b { 2 };
+
+        int num_sum_computations = 0;
+        DerivedProperty sum { [&](int a, int b) {
+            ++num_sum_computations;
+            return a + b;
+        }, a, b };
+
+        // Not computed until read.
+        CHECK_EQ(num_sum_computations, 0);
+        CHECK_EQ(sum.value(), 3);
+        CHECK_EQ(num_sum_computations, 1);
+
+        // Reading again, or reading the version or dirtiness, doesn't recompute.
+        CHECK_EQ(sum.value(), 3);
+        (void)sum.getVersion();
+        (void)sum.isDirty();
+        CHECK_EQ(num_sum_computations, 1);
+
+        // Recomputed once after the inputs are modified, no matter how many were.
+        a = 10;
+        b = 20;
+        CHECK_EQ(num_sum_computations, 1);
+        CHECK_EQ(sum.value(), 30);
+        CHECK_EQ(sum.value(), 30);
+        CHECK_EQ(num_sum_computations, 2);
+
+        // Cleaning the input doesn't modify its value, therefore nothing is recomputed.
+        a.clean([](int) { });
+        CHECK_EQ(sum.value(), 30);
+        CHECK_EQ(num_sum_computations, 2);
+    }
+
+    void testDerivedPropertyChain() {
+        DirtyProperty<int> x { 3 };
+
+        int num_parity_computations = 0, num_label_computations = 0;
+        DerivedProperty parity { [&](int x) {
+            ++num_parity_computations;
+            return x % 2;
+        }, x };
+        DerivedProperty label { [&](int parity) {
+            ++num_label_computations;
+            return parity == 0 ? 'e' : 'o';
+        }, parity };
+
+        CHECK_EQ(label.value(), 'o');
+        CHECK_EQ(num_parity_computations, 1);
+        CHECK_EQ(num_label_computations, 1);
+
+        // Parity is recomputed, but it didn't change, so the label is not (early cutoff).
+        x = 5;
+        CHECK_EQ(label.value(), 'o');
+        CHECK_EQ(num_parity_computations, 2);
+        CHECK_EQ(num_label_computations, 1);
+
+        x = 6;
+        CHECK_EQ(label.value(), 'e');
+        CHECK_EQ(num_parity_computations, 3);
+        CHECK_EQ(num_label_computations, 2);
+
+        // clean() runs once per change.
+        int num_cleans = 0;
+        label.clean([&](char) { ++num_cleans; });
+        label.clean([&](char) { ++num_cleans; });
+        CHECK_EQ(num_cleans, 1);
+        x = 8;
+        label.clean([&](char) { ++num_cleans; });
+        CHECK_EQ(num_cleans, 1);
+        x = 9;
+        label.clean([&](char) { ++num_cleans; });
+        CHECK_EQ(num_cleans, 2);
+    }
+
+    void testDirtyPropertyArray() {
+        DirtyPropertyArray<int> squares { 10 };
+        const auto compute = [&](std::size_t index, int &square) {
+            square = static_cast<int>(index * index);
+        };
+
+        // Every element is dirty at first.
+        CHECK(squares.isAnyDirty());
+        CHECK_EQ(squares.clean(compute), 10U);
+        CHECK(!squares.isAnyDirty());
+        CHECK_EQ(squares[9], 81);
+
+        // Dirty ranges are cleared after they are cleaned, so the second clean recomputes nothing.
+        squares.makeDirty(2, 5);
+        squares.makeDirty(7);
+        std::vector<std::size_t> cleaned_indices;
+        CHECK_EQ(squares.clean([&](std::size_t index, int &square) {
+            cleaned_indices.push_back(index);
+            compute(index, square);
+        }), 4U);
+        CHECK((cleaned_indices == std::vector<std::size_t> { 2, 3, 4, 7 }));
+        CHECK(!squares.isAnyDirty());
+        CHECK_EQ(squares.clean(compute), 0U);
+
+        // Cleaning a sub-range leaves the other dirty elements.
+        squares.makeDirty(0, 10);
+        CHECK_EQ(squares.clean(0, 4, compute), 4U);
+        CHECK(!squares.isDirty(3));
+        CHECK(squares.isDirty(4));
+        CHECK_EQ(squares.clean(4, 10, compute), 6U);
+        CHECK(!squares.isAnyDirty());
+
+        // Resize makes every element dirty.
+        squares.resize(12);
+        CHECK_EQ(squares.clean(compute), 12U);
+        CHECK_EQ(squares[11], 121);
+    }
+}
+
+int main() {
+    testDerivedProperty();
+    testDerivedPropertyChain();
+    testDirtyPropertyArray();
+    return check::exitCode();
+}
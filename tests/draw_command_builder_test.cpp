@@ -0,0 +1,157 @@
+// Tests of the indirect draw command building without OpenGL: instances are grouped by (draw range, material) in the
+// order of a stable sort, and count/firstIndex/baseVertex/baseInstance of each command match its range and bucket.
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <span>
+#include <tuple>
+#include <vector>
+
+#include "Check.hpp"
+#include "DrawCommandBuilder.hpp"
+
+namespace {
+    // Two meshes with two LODs each, as MeshPool lays them out in the shared buffers.
+    const std::vector<DrawRange> ranges {
+        { 0, 36, 0, 0.f },
+        { 36, 12, 0, 0.1f },
+        { 48, 18, 24, 0.f },
+        { 66, 6, 24, 0.2f },
+    };
+
+    struct Object {
+        std::uint32_t range;
+        std::uint32_t material;
+    };
+
+    // Reference: visible indices are sorted by material first (as Scene does for the per object rendering), then the
+    // builder groups them by range. Both are stable, so the result is the stable sort by (range, material).
+    std::vector<std::uint32_t> sortByMaterial(const std::vector<Object> &objects, std::vector<std::uint32_t> indices) {
+        std::ranges::stable_sort(indices, {}, [&](std::uint32_t idx) { return objects[idx].material; });
+        return indices;
+    }
+
+    void checkBuild(DrawCommandBuilder &builder, const std::vector<Object> &objects, const std::vector<std::uint32_t> &visible_indices) {
+        const std::vector material_sorted = sortByMaterial(objects, visible_indices);
+        builder.build(material_sorted, ranges, [&](std::uint32_t idx) { return objects[idx].range; });
+
+        std::vector expected_order = material_sorted;
+        std::ranges::stable_sort(expected_order, {}, [&](std::uint32_t idx) { return std::tuple { objects[idx].range, objects[idx].material }; });
+        CHECK(std::ranges::equal(builder.getInstanceOrder(), expected_order));
+
+        // One command per non-empty range, in the order of the ranges, whose instances are consecutive.
+        std::uint32_t base_instance = 0;
+        std::size_t command_index = 0;
+        for (std::uint32_t range = 0; range < ranges.size(); ++range) {
+            const auto instance_count = static_cast<std::uint32_t>(std::ranges::count_if(visible_indices, [&](std::uint32_t idx) {
+                return objects[idx].range == range;
+            }));
+            if (instance_count == 0) {
+                continue;
+            }
+
+            CHECK(command_index < builder.getCommands().size());
+            if (command_index < builder.getCommands().size()) {
+                const DrawElementsIndirectCommand expected {
+                    .count = ranges[range].index_count,
+                    .instance_count = instance_count,
+                    .first_index = ranges[range].first_index,
+                    .base_vertex = ranges[range].base_vertex,
+                    .base_instance = base_instance,
+                };
+                CHECK(builder.getCommands()[command_index] == expected);
+            }
+            base_instance += instance_count;
+            ++command_index;
+        }
+        CHECK_EQ(builder.getCommands().size(), command_index);
+    }
+
+    void testEmpty() {
+        DrawCommandBuilder builder;
+        builder.build({}, ranges, [](std::uint32_t) { return 0U; });
+        CHECK(builder.getCommands().empty());
+        CHECK(builder.getInstanceOrder().empty());
+    }
+
+    void testSingleMesh() {
+        const std::vector<Object> objects(5, Object { 0, 0 });
+        DrawCommandBuilder builder;
+        checkBuild(builder, objects, { 4, 0, 2, 3, 1 });
+
+        CHECK_EQ(builder.getCommands().size(), 1U);
+        CHECK_EQ(builder.getCommands()[0].base_instance, 0U);
+        CHECK_EQ(builder.getCommands()[0].instance_count, 5U);
+        CHECK_EQ(builder.getCommands()[0].count, 36U);
+        CHECK((std::ranges::equal(builder.getInstanceOrder(), std::vector<std::uint32_t> { 4, 0, 2, 3, 1 })));
+    }
+
+    void testEmptyBuckets() {
+        // Only the coarse LODs of both meshes are drawn.
+        const std::vector<Object> objects { { 3, 0 }, { 1, 0 }, { 3, 0 }, { 1, 0 }, { 1, 0 } };
+        DrawCommandBuilder builder;
+        checkBuild(builder, objects, { 0, 1, 2, 3, 4 });
+
+        const std::vector<DrawElementsIndirectCommand> expected {
+            { .count = 12, .instance_count = 3, .first_index = 36, .base_vertex = 0, .base_instance = 0 },
+            { .count = 6, .instance_count = 2, .first_index = 66, .base_vertex = 24, .base_instance = 3 },
+        };
+        CHECK(std::ranges::equal(builder.getCommands(), expected));
+        CHECK((std::ranges::equal(builder.getInstanceOrder(), std::vector<std::uint32_t> { 1, 3, 4, 0, 2 })));
+
+        // Rebuild replaces the previous commands, including the bucket that became empty.
+        checkBuild(builder, objects, { 0, 2 });
+        CHECK_EQ(builder.getCommands().size(), 1U);
+    }
+
+    void testInterleavedMaterials() {
+        // Ranges and materials alternate with different periods, so every (range, material) pair is interleaved.
+        std::vector<Object> objects;
+        for (std::uint32_t i = 0; i < 24; ++i) {
+            objects.push_back({ i % 4, i % 3 });
+        }
+        std::vector<std::uint32_t> visible_indices(objects.size());
+        std::iota(visible_indices.begin(), visible_indices.end(), 0U);
+
+        DrawCommandBuilder builder;
+        checkBuild(builder, objects, visible_indices);
+        CHECK_EQ(builder.getCommands().size(), 4U);
+
+        // First range holds 0, 4, ..., 20, whose materials are 0, 1, 2, 0, 1, 2.
+        CHECK((std::ranges::equal(builder.getInstanceOrder().first(6), std::vector<std::uint32_t> { 0, 12, 4, 16, 8, 20 })));
+    }
+
+    void testRandom() {
+        std::mt19937 random { 7 };
+        std::uniform_int_distribution<std::uint32_t> range_distribution { 0, static_cast<std::uint32_t>(ranges.size() - 1) };
+        std::uniform_int_distribution<std::uint32_t> material_distribution { 0, 2 };
+
+        std::vector<Object> objects(1000);
+        for (Object &object : objects) {
+            object = { range_distribution(random), material_distribution(random) };
+        }
+
+        DrawCommandBuilder builder;
+        for (int iteration = 0; iteration < 10; ++iteration) {
+            // Random visible subset.
+            std::vector<std::uint32_t> visible_indices;
+            for (std::uint32_t idx = 0; idx < objects.size(); ++idx) {
+                if (random() % 3 != 0) {
+                    visible_indices.push_back(idx);
+                }
+            }
+            checkBuild(builder, objects, visible_indices);
+        }
+    }
+}
+
+int main() {
+    testEmpty();
+    testSingleMesh();
+    testEmptyBuckets();
+    testInterleavedMaterials();
+    testRandom();
+    return check::exitCode();
+}
@@ -0,0 +1,116 @@
+// Tests of the work-stealing job system: parallelFor covers every index exactly once for any grain size and thread
+// count, uneven and nested jobs are distributed over the threads, and destruction executes the outstanding jobs.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "Check.hpp"
+#include "JobSystem.hpp"
+
+namespace {
+    void testParallelForCoverage() {
+        constexpr std::size_t first = 3, last = 10'007;
+        for (std::size_t num_threads : { 1U, 2U, 4U, 8U }) {
+            JobSystem job_system { num_threads };
+            CHECK_EQ(job_system.getNumThreads(), num_threads);
+
+            for (std::size_t grain_size : { 1U, 7U, 1000U, 100'000U }) {
+                std::vector<std::atomic<int>> counts(last);
+                job_system.parallelFor(first, last, grain_size, [&](std::size_t chunk_first, std::size_t chunk_last) {
+                    // Without workers, the whole range is a single chunk.
+                    CHECK(chunk_first < chunk_last && (num_threads == 1 || chunk_last - chunk_first <= grain_size));
+                    for (std::size_t i = chunk_first; i < chunk_last; ++i) {
+                        counts[i].fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+
+                // parallelFor returns after every chunk is done.
+                for (std::size_t i = 0; i < last; ++i) {
+                    CHECK_EQ(counts[i].load(), i < first ? 0 : 1);
+                }
+            }
+
+            // Empty range.
+            bool invoked = false;
+            job_system.parallelFor(5, 5, 1, [&](std::size_t, std::size_t) { invoked = true; });
+            CHECK(!invoked);
+        }
+    }
+
+    void testUnevenJobs() {
+        JobSystem job_system { 4 };
+
+        // Every chunk blocks its thread until another thread executes a chunk, which happens only if the workers steal
+        // the chunks queued by this thread. Timeout prevents the test from hanging if they don't.
+        std::mutex mutex;
+        std::set<std::thread::id> thread_ids;
+        std::vector<std::atomic<int>> counts(64);
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds { 10 };
+        job_system.parallelFor(0, counts.size(), 1, [&](std::size_t chunk_first, std::size_t) {
+            {
+                std::lock_guard lock { mutex };
+                thread_ids.insert(std::this_thread::get_id());
+            }
+            while (std::chrono::steady_clock::now() < deadline) {
+                if (std::lock_guard lock { mutex }; thread_ids.size() >= 2) {
+                    break;
+                }
+                std::this_thread::yield();
+            }
+
+            // Uneven: some chunks are much heavier than the others.
+            if (chunk_first % 16 == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds { 10 });
+            }
+            counts[chunk_first].fetch_add(1, std::memory_order_relaxed);
+        });
+        CHECK(std::ranges::all_of(counts, [](const std::atomic<int> &count) { return count.load() == 1; }));
+        CHECK(thread_ids.size() >= 2);
+
+        // Nested parallelFor: inner chunks are pushed to the queues of the workers, and stolen by the other threads.
+        std::vector<std::atomic<int>> nested_counts(8 * 1000);
+        job_system.parallelFor(0, 8, 1, [&](std::size_t outer, std::size_t) {
+            job_system.parallelFor(outer * 1000, (outer + 1) * 1000, 10, [&](std::size_t chunk_first, std::size_t chunk_last) {
+                // Uneven: later chunks are heavier.
+                std::this_thread::sleep_for(std::chrono::microseconds { chunk_first % 1000 });
+                for (std::size_t i = chunk_first; i < chunk_last; ++i) {
+                    nested_counts[i].fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        });
+        CHECK(std::ranges::all_of(nested_counts, [](const std::atomic<int> &count) { return count.load() == 1; }));
+    }
+
+    void testShutdownWithOutstandingJobs() {
+        for (std::size_t num_threads : { 1U, 3U }) {
+            constexpr int num_jobs = 1000;
+            std::atomic<int> num_executed = 0;
+            {
+                JobSystem job_system { num_threads };
+                for (int i = 0; i < num_jobs; ++i) {
+                    job_system.submit([&, i]() {
+                        if (i % 100 == 0) {
+                            std::this_thread::sleep_for(std::chrono::milliseconds { 1 });
+                        }
+                        num_executed.fetch_add(1, std::memory_order_relaxed);
+                    });
+                }
+                // Destroyed while most of the jobs are queued.
+            }
+            CHECK_EQ(num_executed.load(), num_jobs);
+        }
+    }
+}
+
+int main() {
+    testParallelForCoverage();
+    testUnevenJobs();
+    testShutdownWithOutstandingJobs();
+    return check::exitCode();
+}
@@ -0,0 +1,116 @@
+// Renders a known scene offscreen through a surfaceless EGL context, and checks that the CPU ray cast picks the same
+// object as the stencil and object ID picking at fixed pixels: the background, the cube centers (some of which are
+// behind other cubes), and the screen center where the diagonal cubes overlap.
+//
+// Must be run in the directory where shaders and assets are copied (i.e. build directory).
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <span>
+#include <vector>
+
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+#include "benchmarks/HeadlessContext.hpp"
+#include "Check.hpp"
+#include "Scene.hpp"
+
+namespace {
+    constexpr glm::ivec2 resolution { 320, 320 };
+    constexpr std::uint32_t no_hover_index = 0xFFFFFFFF;
+
+    // Draw a frame without animation, and pick at each position.
+    std::vector<std::uint32_t> pick(Scene &scene, Scene::RenderingMode rendering_mode, Scene::PickingMode picking_mode, std::span<const glm::ivec2> positions) {
+        scene.setRenderingMode(rendering_mode);
+        scene.setPickingMode(picking_mode);
+        scene.setAsyncReadback(false);
+
+        scene.setCursorPosition(std::nullopt);
+        scene.update(0.f);
+        scene.draw();
+        scene.endFrame();
+
+        std::vector<std::uint32_t> hovered_indices;
+        for (glm::ivec2 position : positions) {
+            scene.setCursorPosition(position);
+            if (picking_mode == Scene::PickingMode::CpuRayCast) {
+                scene.update(0.f); // Ray cast picking is done in update.
+            }
+            hovered_indices.push_back(scene.getHoveredIndex());
+        }
+        return hovered_indices;
+    }
+}
+
+int main() {
+    try {
+        HeadlessContext context { resolution };
+        Scene scene { context.getSize(), context.getFramebuffer() };
+
+        // 3x3x3 grid around the origin, seen along the diagonal, therefore the cubes at (i, i, i) are on the center ray.
+        const SceneLayout scene_layout { .num_in_side = 3 };
+        scene.setSceneLayout(scene_layout);
+        scene.setLodSelection(false); // Ray cast tests the full detail mesh.
+        scene.setOcclusionCulling(false);
+
+        const glm::mat4 view = lookAt(glm::vec3 { 5.f }, glm::vec3 { 0.f }, glm::vec3 { 0.f, 1.f, 0.f });
+        const glm::mat4 projection = glm::perspective(glm::radians(45.f), 1.f, 1e-1f, 100.f);
+        scene.setCamera(view, projection);
+
+        // Background at the corners, the overlapping cubes at the center, and the projected center of every cube.
+        std::vector<glm::ivec2> positions {
+            { 0, 0 }, { resolution.x - 1, 0 }, { 0, resolution.y - 1 }, resolution - 1,
+            resolution / 2,
+        };
+        const float half_extent = scene_layout.spacing * static_cast<float>(scene_layout.num_in_side - 1) / 2.f;
+        for (int x = 0; x < scene_layout.num_in_side; ++x) {
+            for (int y = 0; y < scene_layout.num_in_side; ++y) {
+                for (int z = 0; z < scene_layout.num_in_side; ++z) {
+                    const glm::vec4 clip = projection * view * glm::vec4 { scene_layout.spacing * glm::vec3 { x, y, z } - half_extent, 1.f };
+                    const glm::vec2 ndc = glm::vec2 { clip } / clip.w;
+                    positions.emplace_back((0.5f * ndc + 0.5f) * glm::vec2 { resolution });
+                }
+            }
+        }
+
+        const std::vector ray_cast = pick(scene, Scene::RenderingMode::PerObject, Scene::PickingMode::CpuRayCast, positions);
+
+        // Miss.
+        for (std::size_t i = 0; i < 4; ++i) {
+            CHECK_EQ(ray_cast[i], no_hover_index);
+        }
+        // The nearest of the overlapping cubes, at the grid corner (2, 2, 2).
+        CHECK_EQ(ray_cast[4], static_cast<std::uint32_t>(scene.getNumInstances() - 1));
+        // Every projected cube center is on some cube.
+        for (std::size_t i = 5; i < positions.size(); ++i) {
+            CHECK(ray_cast[i] != no_hover_index);
+        }
+
+        const struct {
+            Scene::RenderingMode rendering_mode;
+            Scene::PickingMode picking_mode;
+        } references[] = {
+            { Scene::RenderingMode::PerObject, Scene::PickingMode::Stencil },
+            { Scene::RenderingMode::PerObject, Scene::PickingMode::ObjectId },
+            { Scene::RenderingMode::Instanced, Scene::PickingMode::ObjectId },
+        };
+        for (const auto &[rendering_mode, picking_mode] : references) {
+            const std::vector hovered_indices = pick(scene, rendering_mode, picking_mode, positions);
+            for (std::size_t i = 0; i < positions.size(); ++i) {
+                if (hovered_indices[i] != ray_cast[i]) {
+                    std::cerr << "Position (" << positions[i].x << ", " << positions[i].y << "), rendering mode "
+                              << static_cast<int>(rendering_mode) << ", picking mode " << static_cast<int>(picking_mode) << ":\n";
+                }
+                CHECK_EQ(hovered_indices[i], ray_cast[i]);
+            }
+        }
+    }
+    catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return check::exitCode();
+}
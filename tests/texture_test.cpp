@@ -0,0 +1,284 @@
+// Tests of the texture pipeline without OpenGL: BC1/BC3 encoding error of known blocks (decoded by a reference decoder
+// here), TextureFile write/read round-trip, and TextureCache hits and misses as the cache key changes.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Check.hpp"
+#include "TextureCache.hpp"
+#include "TextureEncoder.hpp"
+#include "TextureFile.hpp"
+
+namespace {
+    using Pixels = std::vector<std::uint8_t>; // RGBA8 of a 4x4 block.
+
+    std::array<int, 3> fromRgb565(std::uint16_t color) {
+        const int r = color >> 11 & 31, g = color >> 5 & 63, b = color & 31;
+        return { r << 3 | r >> 2, g << 2 | g >> 4, b << 3 | b >> 2 };
+    }
+
+    // Reference decoder of a BC1 color block into the RGB of the 16 pixels (alpha untouched).
+    void decodeColorBlock(std::span<const std::byte> block, Pixels &pixels) {
+        const auto read16 = [&](std::size_t offset) {
+            return static_cast<std::uint16_t>(std::to_integer<int>(block[offset]) | std::to_integer<int>(block[offset + 1]) << 8);
+        };
+        const std::uint16_t color0 = read16(0), color1 = read16(2);
+        const std::array c0 = fromRgb565(color0), c1 = fromRgb565(color1);
+
+        std::array<std::array<int, 3>, 4> palette { c0, c1 };
+        for (int channel = 0; channel < 3; ++channel) {
+            if (color0 > color1) {
+                palette[2][channel] = (2 * c0[channel] + c1[channel]) / 3;
+                palette[3][channel] = (c0[channel] + 2 * c1[channel]) / 3;
+            }
+            else {
+                palette[2][channel] = (c0[channel] + c1[channel]) / 2;
+                palette[3][channel] = 0;
+            }
+        }
+
+        const std::uint32_t indices = read16(4) | static_cast<std::uint32_t>(read16(6)) << 16;
+        for (std::size_t i = 0; i < 16; ++i) {
+            const std::array color = palette[indices >> (2 * i) & 3];
+            for (int channel = 0; channel < 3; ++channel) {
+                pixels[4 * i + channel] = static_cast<std::uint8_t>(color[channel]);
+            }
+        }
+    }
+
+    // Reference decoder of a BC3 alpha block into the alpha of the 16 pixels.
+    void decodeAlphaBlock(std::span<const std::byte> block, Pixels &pixels) {
+        const int alpha0 = std::to_integer<int>(block[0]), alpha1 = std::to_integer<int>(block[1]);
+        std::array<int, 8> palette { alpha0, alpha1 };
+        for (int i = 2; i < 8; ++i) {
+            palette[i] = alpha0 > alpha1 ? ((8 - i) * alpha0 + (i - 1) * alpha1) / 7
+                       : i < 6 ? ((6 - i) * alpha0 + (i - 1) * alpha1) / 5
+                       : i == 6 ? 0 : 255;
+        }
+
+        std::uint64_t indices = 0;
+        for (int i = 0; i < 6; ++i) {
+            indices |= static_cast<std::uint64_t>(std::to_integer<int>(block[2 + i])) << (8 * i);
+        }
+        for (std::size_t i = 0; i < 16; ++i) {
+            pixels[4 * i + 3] = static_cast<std::uint8_t>(palette[indices >> (3 * i) & 7]);
+        }
+    }
+
+    // Largest difference of the channels [first_channel, last_channel) over the pixels.
+    int getMaxError(const Pixels &expected, const Pixels &actual, int first_channel, int last_channel) {
+        int max_error = 0;
+        for (std::size_t i = 0; i < expected.size(); i += 4) {
+            for (int channel = first_channel; channel < last_channel; ++channel) {
+                max_error = std::max(max_error, std::abs(expected[i + channel] - actual[i + channel]));
+            }
+        }
+        return max_error;
+    }
+
+    int getBc1Error(const Pixels &pixels) {
+        const std::vector blocks = encodeBc1(pixels, { 4, 4 });
+        CHECK_EQ(blocks.size(), 8U);
+
+        Pixels decoded = pixels;
+        decodeColorBlock(blocks, decoded);
+        return getMaxError(pixels, decoded, 0, 3);
+    }
+
+    int getBc3AlphaError(const Pixels &pixels) {
+        const std::vector blocks = encodeBc3(pixels, { 4, 4 });
+        CHECK_EQ(blocks.size(), 16U);
+
+        Pixels decoded = pixels;
+        decodeAlphaBlock(std::span { blocks }.first(8), decoded);
+        decodeColorBlock(std::span { blocks }.subspan(8), decoded);
+        CHECK(getMaxError(pixels, decoded, 0, 3) == getBc1Error(pixels)); // Same color block as BC1.
+        return getMaxError(pixels, decoded, 3, 4);
+    }
+
+    Pixels makeBlock(auto &&f) {
+        Pixels pixels(64);
+        for (std::size_t i = 0; i < 16; ++i) {
+            const std::array<int, 4> pixel = f(i);
+            std::ranges::copy(pixel, pixels.begin() + 4 * i);
+        }
+        return pixels;
+    }
+
+    void testBlockCompression() {
+        // Solid color: only the RGB565 quantization error remains.
+        const int solid_error = getBc1Error(makeBlock([](std::size_t) { return std::array { 200, 100, 50, 255 }; }));
+        std::cout << "BC1 solid color error: " << solid_error << '\n';
+        CHECK(solid_error <= 4);
+
+        // Two color gradient: colors are on a line, so 4 palette entries along it cover them within a third of the range.
+        const int gradient_error = getBc1Error(makeBlock([](std::size_t i) {
+            const int t = static_cast<int>(i);
+            return std::array { 32 + 12 * t, 64 + 8 * t, 200 - 10 * t, 255 };
+        }));
+        std::cout << "BC1 two color gradient error: " << gradient_error << '\n';
+        CHECK(gradient_error <= 32);
+
+        // Equal luminance chroma gradient, i.e. the variation is orthogonal to (1, 1, 1). The first and last pixels are in
+        // the middle of the range, so that picking them as the endpoints would lose most of the range.
+        constexpr std::array<int, 16> chroma_offsets { 0, -90, -78, -66, -54, -42, -30, -18, 18, 30, 42, 54, 66, 78, 90, 6 };
+        const int chroma_error = getBc1Error(makeBlock([&](std::size_t i) {
+            return std::array { 128 + chroma_offsets[i], 128 - chroma_offsets[i], 128, 255 };
+        }));
+        std::cout << "BC1 equal luminance chroma gradient error: " << chroma_error << '\n';
+        CHECK(chroma_error <= 32);
+
+        // Alpha gradient: 8 interpolated alphas, so the error is at most half of the 1/7 range step.
+        const int alpha_error = getBc3AlphaError(makeBlock([](std::size_t i) {
+            return std::array { 90, 160, 220, static_cast<int>(i * 17) };
+        }));
+        std::cout << "BC3 alpha gradient error: " << alpha_error << '\n';
+        CHECK(alpha_error <= 19);
+
+        // Solid and binary alpha are exact.
+        CHECK_EQ(getBc3AlphaError(makeBlock([](std::size_t) { return std::array { 90, 160, 220, 128 }; })), 0);
+        CHECK_EQ(getBc3AlphaError(makeBlock([](std::size_t i) { return std::array { 90, 160, 220, i % 3 == 0 ? 0 : 255 }; })), 0);
+    }
+
+    ImageLevel makeImage(glm::ivec2 size, std::uint8_t alpha) {
+        ImageLevel image { size, {} };
+        for (int y = 0; y < size.y; ++y) {
+            for (int x = 0; x < size.x; ++x) {
+                image.pixels.insert(image.pixels.end(), {
+                    static_cast<std::uint8_t>(16 * x), static_cast<std::uint8_t>(16 * y), static_cast<std::uint8_t>(x * y), alpha,
+                });
+            }
+        }
+        return image;
+    }
+
+    void testTextureFileRoundTrip(const std::filesystem::path &directory) {
+        const ImageLevel image = makeImage({ 12, 8 }, 255);
+        const std::vector levels = generateMipChain(image.pixels, image.size);
+        CHECK_EQ(levels.size(), 4U); // 12x8, 6x4, 3x2, 1x1.
+
+        for (TextureFile::Format format : { TextureFile::Format::Rgba8, TextureFile::Format::Bc1, TextureFile::Format::Bc3 }) {
+            const std::vector bytes = TextureFile::encode(format, 0x0123456789ABCDEF, levels);
+            const std::filesystem::path path = directory / "round_trip.tex";
+            TextureFile::write(path, bytes);
+
+            for (const TextureFile &file : { TextureFile { path }, TextureFile { bytes } }) {
+                const TextureFile::Header &header = file.getHeader();
+                CHECK(header.format == format);
+                CHECK_EQ(header.level_count, levels.size());
+                CHECK_EQ(header.source_hash, 0x0123456789ABCDEFU);
+                for (std::uint32_t level = 0; level < header.level_count; ++level) {
+                    CHECK_EQ(header.levels[level].width, static_cast<std::uint32_t>(levels[level].size.x));
+                    CHECK_EQ(header.levels[level].height, static_cast<std::uint32_t>(levels[level].size.y));
+                    CHECK_EQ(header.levels[level].offset % TextureFile::blob_alignment, 0U);
+
+                    const ImageLevel &image_level = levels[level];
+                    const std::vector<std::byte> expected = format == TextureFile::Format::Bc1 ? encodeBc1(image_level.pixels, image_level.size)
+                        : format == TextureFile::Format::Bc3 ? encodeBc3(image_level.pixels, image_level.size)
+                        : std::vector<std::byte>(reinterpret_cast<const std::byte*>(image_level.pixels.data()), reinterpret_cast<const std::byte*>(image_level.pixels.data() + image_level.pixels.size()));
+                    CHECK(std::ranges::equal(file.getLevelData(level), expected));
+                }
+            }
+        }
+
+        // Truncated content is rejected.
+        std::vector bytes = TextureFile::encode(TextureFile::Format::Rgba8, 0, levels);
+        bytes.resize(bytes.size() - 1);
+        bool thrown = false;
+        try {
+            const TextureFile file { bytes };
+        }
+        catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+
+    // Binary PPM, which is decoded by stb_image like the PNG assets.
+    void writePpm(const std::filesystem::path &path, const ImageLevel &image) {
+        std::ofstream output { path, std::ios::binary };
+        output << "P6\n" << image.size.x << ' ' << image.size.y << "\n255\n";
+        for (std::size_t i = 0; i < image.pixels.size(); i += 4) {
+            output.write(reinterpret_cast<const char*>(&image.pixels[i]), 3);
+        }
+    }
+
+    void testTextureCache(const std::filesystem::path &directory) {
+        const std::filesystem::path source_path = directory / "source.ppm";
+        const std::filesystem::path cache_directory = directory / "cache";
+        writePpm(source_path, makeImage({ 8, 8 }, 255));
+
+        {
+            TextureCache cache { cache_directory, true };
+            const TextureFile converted = cache.loadFile(source_path);
+            CHECK(converted.getHeader().format == TextureFile::Format::Bc1); // Opaque.
+            CHECK_EQ(cache.getStatistics().num_misses, 1U);
+            CHECK_EQ(cache.getStatistics().num_hits, 0U);
+
+            // Same source, same key.
+            const TextureFile cached = cache.loadFile(source_path);
+            CHECK(std::ranges::equal(cached.getLevelData(0), converted.getLevelData(0)));
+            CHECK_EQ(cache.getStatistics().num_misses, 1U);
+            CHECK_EQ(cache.getStatistics().num_hits, 1U);
+        }
+
+        // Cache file is reused by another cache of the same directory, e.g. next run.
+        {
+            TextureCache cache { cache_directory, true };
+            (void)cache.loadFile(source_path);
+            CHECK_EQ(cache.getStatistics().num_hits, 1U);
+            CHECK_EQ(cache.getStatistics().num_misses, 0U);
+        }
+
+        // Key changes with the compression support.
+        {
+            TextureCache cache { cache_directory, false };
+            CHECK(cache.loadFile(source_path).getHeader().format == TextureFile::Format::Rgba8);
+            CHECK_EQ(cache.getStatistics().num_misses, 1U);
+            (void)cache.loadFile(source_path);
+            CHECK_EQ(cache.getStatistics().num_hits, 1U);
+        }
+
+        // Key changes with the source content.
+        {
+            writePpm(source_path, makeImage({ 4, 4 }, 255));
+            TextureCache cache { cache_directory, true };
+            const TextureFile converted = cache.loadFile(source_path);
+            CHECK_EQ(converted.getHeader().levels[0].width, 4U);
+            CHECK_EQ(cache.getStatistics().num_misses, 1U);
+            CHECK_EQ(cache.getStatistics().num_hits, 0U);
+        }
+
+        // One file per key.
+        CHECK_EQ(std::distance(std::filesystem::directory_iterator { cache_directory }, std::filesystem::directory_iterator {}), 3);
+    }
+}
+
+int main() {
+    testBlockCompression();
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "mouse_picking_texture_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    try {
+        testTextureFileRoundTrip(directory);
+        testTextureCache(directory);
+    }
+    catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        ++check::num_failures;
+    }
+    std::filesystem::remove_all(directory);
+
+    return check::exitCode();
+}
@@ -0,0 +1,83 @@
+// Converts a text mesh (one vertex per line: position, normal and texcoords, as in assets/models/cube.txt) to the binary
+// mesh file which can be memory mapped by MeshFile. Identical vertices are welded into an indexed mesh, whose triangles
+// and vertices are reordered for the vertex cache and fetch locality. ACMR of each step is reported.
+//
+// Coarser levels of detail are simplified from the mesh with halved triangle counts, and stored with their errors. The
+// chain ends when a level would not remove a quarter of the triangles of the previous one, or when the error exceeds the
+// half of the bounding radius. Since the renderer selects a level by its projected error, coarse levels are used only
+// where the error is smaller than a pixel.
+//
+// Usage: mesh_converter <input.txt> <output.mesh>
+
+#include <algorithm>
+#include <exception>
+#include <fstream>
+#include <vector>
+
+#include <glm/geometric.hpp>
+
+#include <fmt/core.h>
+
+#include "MeshFile.hpp"
+#include "MeshOptimizer.hpp"
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        fmt::print(stderr, "Usage: {} <input.txt> <output.mesh>\n", argv[0]);
+        return 1;
+    }
+
+    try {
+        std::ifstream input { argv[1] };
+        if (!input.is_open()) {
+            fmt::print(stderr, "Failed to open {}\n", argv[1]);
+            return 1;
+        }
+
+        std::vector<VertexPNT> vertices;
+        for (VertexPNT vertex; input >> vertex;) {
+            vertices.push_back(vertex);
+        }
+        if (!input.eof()) {
+            fmt::print(stderr, "Failed to parse {} at vertex {}\n", argv[1], vertices.size());
+            return 1;
+        }
+
+        IndexedMeshData mesh = weldVertices(vertices);
+        const float welded_acmr = computeAcmr(mesh.indices);
+        optimizeVertexCache(mesh.indices, mesh.vertices.size());
+        optimizeVertexFetch(mesh);
+
+        // Every level is simplified from LOD 0, so that its error is measured from the original surface.
+        float radius = 0.f;
+        for (const VertexPNT &vertex : mesh.vertices) {
+            radius = std::max(radius, glm::length(vertex.position));
+        }
+        std::vector<std::uint32_t> lod_indices = mesh.indices;
+        std::vector<MeshFile::Lod> lods { { 0, static_cast<std::uint32_t>(mesh.indices.size()), 0.f, 0 } };
+        while (lods.size() < MeshFile::max_lod_count) {
+            const std::size_t previous_index_count = lods.back().index_count;
+            float error;
+            std::vector<std::uint32_t> simplified = simplifyMesh(mesh.vertices, mesh.indices, previous_index_count / 6 * 3, 0.5f * radius, error);
+            if (simplified.empty() || 4 * simplified.size() > 3 * previous_index_count) {
+                break;
+            }
+
+            optimizeVertexCache(simplified, mesh.vertices.size());
+            lods.push_back({ static_cast<std::uint32_t>(lod_indices.size()), static_cast<std::uint32_t>(simplified.size()), error, 0 });
+            lod_indices.insert(lod_indices.end(), simplified.begin(), simplified.end());
+        }
+
+        MeshFile::write(argv[2], mesh.vertices, lod_indices, lods);
+        fmt::print("{}: {} -> {} vertices, {} triangles\n", argv[2], vertices.size(), mesh.vertices.size(), mesh.indices.size() / 3);
+        fmt::print("ACMR (FIFO cache of {} vertices): non-indexed 3.000, welded {:.3f}, optimized {:.3f}\n",
+                   vertex_cache_size, welded_acmr, computeAcmr(mesh.indices));
+        for (std::size_t lod = 1; lod < lods.size(); ++lod) {
+            fmt::print("LOD {}: {} triangles, error {:.4f}\n", lod, lods[lod].index_count / 3, lods[lod].error);
+        }
+    }
+    catch (const std::exception &e) {
+        fmt::print(stderr, "{}\n", e.what());
+        return 1;
+    }
+}